@@ -0,0 +1,494 @@
+/**
+ * @file bench.cpp
+ * @brief Synthetic load benchmarks of the console core
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Benchmarks
+ *
+ * @details
+ * Runs against the headless core (see platform_posix.cpp) in a scratch plugin directory under the
+ * system temporary folder. Usage: `bench [records...]`, by default 10k, 100k and 1M records. Each
+ * result is printed as one JSON object per line, with the total and the per operation time.
+ */
+
+#include "console.hpp"
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <thread>
+
+//--------------------------------------------------------------------------------------------------
+
+/// Reproducible across runs, so the results are comparable
+static std::mt19937 rng (42);
+
+static std::size_t
+random (std::size_t n)
+{
+    return std::uniform_int_distribution<std::size_t> (0, n-1) (rng);
+}
+
+/// A copy in upper case, as the filters matched before text_search
+static std::string
+uppercase_string (std::string s)
+{
+    for (char& c: s) c = c >= 'a' && c <= 'z' ? char (c - ('a' - 'A')) : c;
+    return s;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<class F>
+static void
+measure (std::string const& name, std::size_t records, std::size_t ops, F&& func)
+{
+    using namespace std::chrono;
+    auto t0 = steady_clock::now ();
+    func ();
+    auto ns = duration<double, std::nano> (steady_clock::now () - t0).count ();
+
+    nlohmann::json json = {
+        { "name", name },
+        { "records", records },
+        { "ops", ops },
+        { "ms", ns / 1e6 },
+        { "ns_per_op", ops ? ns / double (ops) : 0. }
+    };
+    std::cout << json.dump () << std::endl;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static const char* objects[] = {
+    "player", "0001a66b", "00013bbf", "000a2c94", "0010f7f3", "00039bbf", "0003c57c", "00019e07"
+};
+static const char* functions[] = {
+    "additem", "removeitem", "getav", "setav", "modav", "moveto", "placeatme", "disable",
+    "enable", "resurrect", "kill", "getpos", "setpos", "getangle", "equipitem", "unequipitem"
+};
+static const char* values[] = {
+    "health", "magicka", "stamina", "onehanded", "destruction", "x", "y", "z", "0000000f", "100"
+};
+
+/// Close to what a player types: mostly "ref.function args", with some plain commands
+static std::string
+random_command ()
+{
+    switch (random (8))
+    {
+        case 0: return "tgm";
+        case 1: return "coc riverwood";
+        default: return std::string (objects[random (std::size (objects))]) + '.'
+                     + functions[random (std::size (functions))] + ' '
+                     + values[random (std::size (values))] + ' ' + std::to_string (random (1000));
+    }
+}
+
+/// Feedback from the game, sometimes spanning few lines
+static std::string
+random_feedback (std::string const& cmd)
+{
+    switch (random (10))
+    {
+        case 0: return "Item '" + cmd + "' not found for parameter Inventory Object.";
+        case 1: return "Compiled script not saved!\nScript command \"" + cmd + "\" not found.";
+        default: return cmd + " >> " + std::to_string (random (10000)) + ".00";
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+clear_log ()
+{
+    console.log_filter.reset ();
+    console.log_data.clear ();
+    console.log_indexes.clear ();
+    console.counter_in = console.counter_out = 0;
+    console.current_history = 0;
+}
+
+/// How record_log_message() used to format and store, as a reference to compare with
+static void
+record_log_message_stream (bool outgoing, std::string const& msg)
+{
+    std::stringstream ss;
+
+    auto now_c = std::time (nullptr);
+    auto loc_c = std::localtime (&now_c);
+    ss << std::put_time (loc_c, "[%Y-%m-%d %H:%M:%S]");
+
+    if (outgoing)
+        ss << ++console.counter_out << '>';
+    else
+        ss << ++console.counter_in  << '<';
+    ss << ' ';
+
+    log_index ndx;
+    ndx.out = outgoing;
+    ndx.time = std::uint32_t (now_c);
+    ndx.counter = std::uint32_t (outgoing ? console.counter_out : console.counter_in);
+
+    ss << trimmed_both (msg, ' ');
+    auto str = ss.str ();
+    ndx.begin = console.log_data.append (str);
+    ndx.size = std::uint32_t (std::min (str.size (), log_text::chunk_size));
+
+    console.log_indexes.push_back (ndx);
+}
+
+/// Pre-generated, so only the recording itself gets measured
+static std::vector<std::pair<bool, std::string>>
+synthetic_log (std::size_t records)
+{
+    std::vector<std::pair<bool, std::string>> log;
+    log.reserve (records);
+    while (log.size () < records)
+    {
+        auto cmd = random_command ();
+        log.emplace_back (true, cmd);
+        for (std::size_t i = 0, n = random (3); i < n && log.size () < records; ++i)
+            log.emplace_back (false, random_feedback (cmd));
+    }
+    return log;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+bench_log (std::size_t records, std::filesystem::path const& dir)
+{
+    auto const records_text = std::to_string (records);
+    auto log = synthetic_log (records);
+
+    clear_log ();
+    measure ("record_log_message_stream", records, records, [&log] {
+        for (auto const& [out, msg]: log)
+            record_log_message_stream (out, msg);
+    });
+
+    clear_log ();
+    measure ("record_log_message", records, records, [&log] {
+        for (auto const& [out, msg]: log)
+            record_log_message (out, msg);
+    });
+
+    // One pass over all the records, as each filter keystroke does
+    const std::string needle = "player.additem";
+    std::size_t hits = 0;
+    measure ("scan_uppercase_find", records, records, [&needle, &hits] {
+        auto upper = uppercase_string (needle);
+        for (auto const& i: console.log_indexes)
+        {
+            auto [b, e] = extract_message (console.log_data, i);
+            hits += uppercase_string (std::string (b, e)).find (upper) != std::string::npos;
+        }
+    });
+    measure ("scan_text_search", records, records, [&needle, &hits] {
+        text_search search (needle);
+        for (auto const& i: console.log_indexes)
+        {
+            auto [b, e] = extract_message (console.log_data, i);
+            hits -= search.contains (b, e);
+        }
+    });
+    if (hits)
+        std::cerr << "Mismatch of the scans: " << hits << std::endl;
+
+    // Typing and then deleting char by char a needle, as the filter input box does. Without the
+    // worker thread, as the filtering itself is measured.
+    console.log_filter.background (0);
+    measure ("filter_type", records, needle.size (), [&needle] {
+        for (std::size_t i = 1; i <= needle.size (); ++i)
+            console.log_filter.update (needle.substr (0, i).c_str ());
+    });
+    measure ("filter_backspace", records, needle.size (), [&needle] {
+        for (std::size_t i = needle.size (); i--; )
+            console.log_filter.update (needle.substr (0, i).c_str ());
+    });
+    measure ("filter_retype", records, needle.size (), [&needle] {
+        for (std::size_t i = 1; i <= needle.size (); ++i)
+            console.log_filter.update (needle.substr (0, i).c_str ());
+    });
+
+    // A query with more terms, narrowing down the cached result of the first one
+    const std::string query = "player.additem -riverwood out:";
+    console.log_filter.reset ();
+    measure ("filter_type_query", records, query.size (), [&query] {
+        for (std::size_t i = 1; i <= query.size (); ++i)
+            console.log_filter.update (query.substr (0, i).c_str ());
+    });
+    console.log_filter.update ("");
+
+    // Same with the text folded in advance, and how much memory it took
+    console.fold_copies = true;
+    measure ("fold_log_copy", records, records, [] {
+        fold_log_copy ();
+    });
+    console.log_filter.reset ();
+    measure ("filter_type_folded", records, needle.size (), [&needle] {
+        for (std::size_t i = 1; i <= needle.size (); ++i)
+            console.log_filter.update (needle.substr (0, i).c_str ());
+    });
+    console.log_filter.update ("");
+    std::cerr << memory_usage () << std::endl;
+    console.fold_copies = false;
+    fold_log_copy ();
+
+    // Same with the trigram index, which may skip most of the records
+    console.index_log = true;
+    measure ("index_log_trigrams", records, records, [] {
+        index_log_trigrams ();
+    });
+    console.log_filter.reset ();
+    measure ("filter_type_indexed", records, needle.size (), [&needle] {
+        for (std::size_t i = 1; i <= needle.size (); ++i)
+            console.log_filter.update (needle.substr (0, i).c_str ());
+    });
+    console.log_filter.reset ();
+    measure ("filter_rare_indexed", records, 1, [] {
+        console.log_filter.update ("riverwood");
+    });
+    console.log_filter.update ("");
+    console.index_log = false;
+    index_log_trigrams ();
+    console.log_filter.reset ();
+    measure ("filter_rare", records, 1, [] {
+        console.log_filter.update ("riverwood");
+    });
+    console.log_filter.update ("");
+
+    // Same on one core, to compare with the above, in parts over all of them
+    console.log_filter.parallel (0);
+    console.log_filter.reset ();
+    measure ("filter_rare_serial", records, 1, [] {
+        console.log_filter.update ("riverwood");
+    });
+    console.log_filter.update ("");
+    console.log_filter.parallel (std::size_t (1) << 15);
+
+    // A compiled pattern, with its literal checked first, and a glob with none
+    console.log_filter.reset ();
+    measure ("filter_regex", records, 1, [] {
+        console.log_filter.update ("re:river\\w+ \\d+");
+    });
+    console.log_filter.reset ();
+    measure ("filter_glob", records, 1, [] {
+        console.log_filter.update ("glob:*a?d*");
+    });
+    console.log_filter.update ("");
+    std::cerr << "Parallel threads: " << parallel_threads () << std::endl;
+
+    // Stepping through the matches of the whole log, scanned only as far as the steps go
+    const std::size_t steps = 100;
+    console.log_finder.find ("riverwood");
+    measure ("find_previous", records, steps, [] {
+        for (std::size_t i = 0; i < steps; ++i)
+            console.log_finder.previous ();
+    });
+    measure ("find_next", records, steps, [] {
+        for (std::size_t i = 0; i < steps; ++i)
+            console.log_finder.next ();
+    });
+    console.log_finder.reset ();
+
+    // Only the frame side of typing, while the worker filters, and then waiting for the result
+    console.log_filter.background (1);
+    console.log_filter.reset ();
+    measure ("filter_type_background", records, needle.size (), [&needle] {
+        for (std::size_t i = 1; i <= needle.size (); ++i)
+            console.log_filter.update (needle.substr (0, i).c_str ());
+    });
+    measure ("filter_background_wait", records, 1, [] {
+        while (console.log_filter.pending ())
+        {
+            std::this_thread::yield ();
+            console.log_filter.poll ();
+        }
+    });
+    console.log_filter.background (0);
+    console.log_filter.update ("");
+
+    // What each executed command does with an active filter
+    const std::size_t appends = 100;
+    console.log_filter.update (needle.c_str ());
+    measure ("filter_append", records, appends, [&needle] {
+        for (std::size_t i = 0; i < appends; ++i)
+        {
+            record_log_message (true, "player.additem 0000000f 1");
+            record_log_message (false, "player.additem 0000000f 1 >> 1.00");
+            console.log_filter.update (needle.c_str ());
+        }
+    });
+    console.log_filter.update ("");
+
+    auto file = dir / ("bench-" + records_text + ".log");
+    measure ("save_log_file", records, console.log_indexes.size (), [&file] {
+        save_log_file (file);
+    });
+    measure ("load_log_file", records, console.log_indexes.size (), [&file] {
+        load_log_file (file);
+    });
+    console.log_filter.reset ();
+
+    // Bounded log, which keeps evicting with an active filter
+    clear_log ();
+    console.log_max_records = records / 4;
+    console.log_filter.update (needle.c_str ());
+    measure ("record_log_message_bounded", records, records, [&log, &needle] {
+        for (auto const& [out, msg]: log)
+        {
+            record_log_message (out, msg);
+            console.log_filter.update (needle.c_str ());
+        }
+    });
+    console.log_max_records = 0;
+    console.log_filter.update ("");
+    console.log_filter.reset ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Skyrim & GUI help are of fixed size, but the aliases can be of any
+static void
+write_help_file (std::filesystem::path const& path, std::string const& prefix, std::size_t n)
+{
+    nlohmann::json json = nlohmann::json::array ();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto name = prefix + functions[i % std::size (functions)] + std::to_string (i);
+        json.push_back ({
+            { "names", { name, name.substr (0, 3) + std::to_string (i) }},
+            { "params", "<object> <count>" },
+            { "brief", "Does the " + name + " thing with the object." },
+            { "details", "Longer explanation of " + name + ", which goes on\nand on." }
+        });
+    }
+    std::ofstream (path) << json.dump (4);
+}
+
+static void
+bench_help (std::size_t aliases)
+{
+    auto dir = std::filesystem::path (plugin_directory ());
+    write_help_file (dir / "help_sse.json", "", 136);
+    write_help_file (dir / "help_gui.json", "/", 20);
+    write_help_file (dir / "help_alias.json", ".", aliases);
+
+    measure ("load_help_files", aliases, 1, [] {
+        load_help_files ();
+    });
+
+    // Tab, with few more presses to cycle through the matches
+    const std::size_t presses = 1000;
+    measure ("tab_completion", aliases, presses, [] {
+        text_completion completion;
+        const char* prefixes[] = { "ad", "get", "pl", ".mo", ".set", "/fi", "xyz" };
+        for (std::size_t i = 0; i < presses; )
+        {
+            std::string text = prefixes[i % std::size (prefixes)];
+            for (int k = 0; k < 4 && i < presses; ++k, ++i)
+            {
+                int start, count;
+                auto s = completion.complete (text, int (text.size ()), start, count);
+                if (!s)
+                {
+                    ++i;
+                    break;
+                }
+                text.replace (std::size_t (start), std::size_t (count), std::string (s) + ' ');
+                completion.completed (text);
+            }
+        }
+    });
+
+    // Tab on mistyped names, after a reference too, so matched fuzzily over all of the completers
+    measure ("tab_completion_fuzzy", aliases, presses, [] {
+        text_completion completion;
+        const char* typos[] = { "adtem", "player.gtav", ".mdav", "/fltr" };
+        for (std::size_t i = 0; i < presses; ++i)
+        {
+            std::string text = typos[i % std::size (typos)];
+            int start, count;
+            completion.complete (text, int (text.size ()), start, count);
+        }
+    });
+
+    // Typing a name into the search over all of the help, as ranked
+    const std::string name = "additem";
+    measure ("help_search_type", aliases, name.size (), [&name] {
+        console.all_help.update ("");
+        for (std::size_t i = 1; i <= name.size (); ++i)
+            console.all_help.update (name.substr (0, i).c_str ());
+    });
+
+    // The same, mistyped, so mostly ranked by the fuzzy scores
+    const std::string typo = "adtem";
+    measure ("help_search_fuzzy", aliases, typo.size (), [&typo] {
+        console.all_help.update ("");
+        for (std::size_t i = 1; i <= typo.size (); ++i)
+            console.all_help.update (typo.substr (0, i).c_str ());
+    });
+    console.all_help.update ("");
+
+    // Expansion of an user alias through the whole command execution path
+    clear_log ();
+    execute_command ("/alias bench-alias player.additem <item> <count>");
+    const std::size_t runs = 10000;
+    measure ("execute_alias", aliases, runs, [] {
+        for (std::size_t i = 0; i < runs; ++i)
+            execute_command (".bench-alias 0000000f 100");
+    });
+    clear_log ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int
+main (int argc, char* argv[])
+{
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i)
+        sizes.push_back (std::stoul (argv[i]));
+    if (sizes.empty ())
+        sizes = { 10'000, 100'000, 1'000'000 };
+
+    auto dir = std::filesystem::temp_directory_path () / "sse-console-bench";
+    std::filesystem::create_directories (dir);
+    std::filesystem::current_path (dir);
+    std::filesystem::create_directories (plugin_directory ());
+
+    setup_console ();
+    console.execution_delay = 100;
+
+    for (auto n: sizes)
+        bench_log (n, dir);
+    for (std::size_t n: { 100, 1000, 5000 })
+        bench_help (n);
+
+    std::filesystem::remove_all (dir);
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
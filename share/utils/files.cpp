@@ -1,6 +1,6 @@
 /**
  * @file file.cpp
- * @brief Common across plugins JSON and ImGui file ops.
+ * @brief Common across plugins ImGui font file ops.
  * @internal
  *
  * This file is part of General Utilities project (aka Utils).
@@ -30,58 +30,6 @@
 
 //--------------------------------------------------------------------------------------------------
 
-void
-save_json (nlohmann::json& json, std::filesystem::path const& file)
-{
-    int maj, min, patch;
-    const char* timestamp;
-    plugin_version (&maj, &min, &patch, &timestamp);
-
-    try
-    {
-        auto& j = json["version"];
-        j["major"] = maj;
-        j["minor"] = min;
-        j["patch"] = patch;
-        j["timestamp"] = timestamp;
-
-        std::ofstream of (file);
-        if (!of.is_open ())
-            log () << "Unable to open " << file << " for writting." << std::endl;
-        else
-            of << json.dump (4);
-    }
-    catch (std::exception const& ex)
-    {
-        log () << "Unable to save " << file << " as JSON: " << ex.what () << std::endl;
-        throw ex;
-    }
-}
-
-//--------------------------------------------------------------------------------------------------
-
-nlohmann::json
-load_json (std::filesystem::path const& file)
-{
-    try
-    {
-        nlohmann::json json = nlohmann::json::object ();
-        std::ifstream fi (file);
-        if (!fi.is_open ())
-            log () << "Unable to open " << file << " for reading." << std::endl;
-        else
-            fi >> json;
-        return json;
-    }
-    catch (std::exception const& ex)
-    {
-        log () << "Unable to parse " << file << " as JSON: " << ex.what () << std::endl;
-        throw ex;
-    }
-}
-
-//--------------------------------------------------------------------------------------------------
-
 void
 load_font (nlohmann::json const& json, font_t& font)
 {
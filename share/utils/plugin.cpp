@@ -23,7 +23,9 @@
  */
 
 #include <utils/plugin.hpp>
-#include <utils/winutils.hpp>
+#if defined(_WIN32)
+#  include <utils/winutils.hpp>
+#endif
 
 #include <iomanip>
 #include <chrono>
@@ -49,7 +51,11 @@ plugin_version (int* maj, int* min, int* patch, const char** timestamp)
 
 std::string const& plugin_directory ()
 {
+#if defined(_WIN32)
     static std::string v = "data\\skse\\plugins\\" + plugin_name () + "\\";
+#else
+    static std::string v = "data/skse/plugins/" + plugin_name () + "/";
+#endif
     return v;
 }
 
@@ -59,11 +65,13 @@ void
 open_log (std::string const& basename)
 {
     std::string destination = "";
+#if defined(_WIN32)
     if (known_folder_path (FOLDERID_Documents, destination))
     {
         // Before plugins are loaded, SKSE takes care to create the directiories
         destination += "\\My Games\\Skyrim Special Edition\\SKSE\\";
     }
+#endif
     destination += basename + ".log";
     logfile.open (destination);
 }
@@ -94,7 +102,63 @@ log ()
 std::uintptr_t
 skyrim_base ()
 {
+#if defined(_WIN32)
     return reinterpret_cast<std::uintptr_t> (::GetModuleHandle (nullptr));
+#else
+    return 0;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+save_json (nlohmann::json& json, std::filesystem::path const& file)
+{
+    int maj, min, patch;
+    const char* timestamp;
+    plugin_version (&maj, &min, &patch, &timestamp);
+
+    try
+    {
+        auto& j = json["version"];
+        j["major"] = maj;
+        j["minor"] = min;
+        j["patch"] = patch;
+        j["timestamp"] = timestamp;
+
+        std::ofstream of (file);
+        if (!of.is_open ())
+            log () << "Unable to open " << file << " for writting." << std::endl;
+        else
+            of << json.dump (4);
+    }
+    catch (std::exception const& ex)
+    {
+        log () << "Unable to save " << file << " as JSON: " << ex.what () << std::endl;
+        throw ex;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+nlohmann::json
+load_json (std::filesystem::path const& file)
+{
+    try
+    {
+        nlohmann::json json = nlohmann::json::object ();
+        std::ifstream fi (file);
+        if (!fi.is_open ())
+            log () << "Unable to open " << file << " for reading." << std::endl;
+        else
+            fi >> json;
+        return json;
+    }
+    catch (std::exception const& ex)
+    {
+        log () << "Unable to parse " << file << " as JSON: " << ex.what () << std::endl;
+        throw ex;
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -26,11 +26,13 @@
  */
 
 #include "console.hpp"
+#include "platform.hpp"
+#include "fuzzy.hpp"
 #include <utils/misc.hpp>
-#include <gsl/gsl_util>
-#include <iomanip>
+#include <cstring>
 #include <ctime>
 #include <sstream>
+#include <charconv>
 
 //--------------------------------------------------------------------------------------------------
 
@@ -45,77 +47,1242 @@ plugin_name ()
 
 //--------------------------------------------------------------------------------------------------
 
-bool
-setup ()
+/// Filtering that many log records takes about a millisecond, too much for a frame
+static constexpr std::size_t log_background_records = 1 << 16;
+
+/// Below that many records, waking up the other threads would take longer than the filtering
+static constexpr std::size_t log_parallel_records = 1 << 15;
+
+/// Of the mistyped names, the closest that many are offered, in completion or in the help search
+static constexpr std::size_t fuzzy_completions = 16;
+static constexpr std::size_t fuzzy_help_results = 32;
+
+void
+setup_console ()
 {
-    extern void ImGuiInputTextCallbackData_DeleteChars (ImGuiInputTextCallbackData*, int, int);
-    imgui.ImGuiInputTextCallbackData_DeleteChars = ImGuiInputTextCallbackData_DeleteChars;
+    console.current_history = 0;
+    console.log_filter.init (&console.log_data, &console.log_indexes);
+    console.log_filter.background (log_background_records);
+    console.log_filter.parallel (log_parallel_records);
+    console.log_filter.lookup ([] (std::string_view needle, std::vector<std::uint32_t>& dst)
+    {
+        return console.index_log && console.log_trigrams.candidates (needle, dst);
+    });
+    console.sse_filter.init (&console.sse_data, &console.sse_indexes);
+    console.gui_filter.init (&console.gui_data, &console.gui_indexes);
+    console.alias_filter.init (&console.alias_data, &console.alias_indexes);
+    console.all_help.init ();
+    console.log_scope = log_query {};
+    console.log_find = false;
+    console.log_finder.init (&console.log_data, &console.log_indexes);
+    console.scroll_to_bottom = false;
+    console.scroll_to_found = false;
+    console.log_to_clipboard = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called for each command and its feedback, hence written straight into the log storage, without
+ * allocations. The prompt is made out of the time and counter only when shown or saved.
+ */
+
+void
+record_log_message (bool outgoing, std::string_view msg)
+{
+    msg.remove_prefix (std::min (msg.find_first_not_of (' '), msg.size ()));
+    msg.remove_suffix (msg.size () - (msg.find_last_not_of (' ') + 1));
+
+    auto size = std::min (msg.size (), log_text::chunk_size);
+    std::copy_n (msg.data (), size, console.log_data.prepare (size));
+    if (console.fold_copies)
+    {
+        std::transform (msg.data (), msg.data () + size,
+                console.log_folded.prepare (size), fold_ascii);
+        console.log_folded.commit (size);
+    }
+    if (console.index_log)
+        console.log_trigrams.add (msg.data (), msg.data () + size);
+
+    log_index ndx;
+    ndx.begin = console.log_data.commit (size);
+    ndx.out = outgoing;
+    ndx.size = std::uint32_t (size);
+    ndx.time = std::uint32_t (std::time (nullptr));
+    ndx.counter = std::uint32_t (outgoing ? ++console.counter_out : ++console.counter_in);
+
+    console.log_indexes.push_back (ndx);
+    evict_log_records ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+fold_log_copy ()
+{
+    if (!console.fold_copies)
+    {
+        console.log_folded.clear ();
+        console.log_filter.fold (nullptr);
+        console.log_finder.fold (nullptr);
+        return;
+    }
+    // Anew, as the old chunks may be still read by a background filter
+    log_text folded;
+    folded.mirror (console.log_data);
+    for (auto const& i: console.log_indexes)
+    {
+        auto [b, e] = extract_message (console.log_data, i);
+        std::transform (b, e, folded.data (i.begin), fold_ascii);
+    }
+    console.log_folded.swap (folded);
+    console.log_filter.fold (&console.log_folded);
+    console.log_finder.fold (&console.log_folded);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+fold_help_copy (std::vector<char> const& data, std::vector<char>& folded,
+        records_filter<help_index>& filter)
+{
+    folded.clear ();
+    if (console.fold_copies)
+        std::transform (data.cbegin (), data.cend (), std::back_inserter (folded), fold_ascii);
+    else
+        folded.shrink_to_fit ();
+    filter.fold (console.fold_copies ? &folded : nullptr);
+}
+
+void
+fold_help_copies ()
+{
+    fold_help_copy (console.sse_data, console.sse_folded, console.sse_filter);
+    fold_help_copy (console.gui_data, console.gui_folded, console.gui_filter);
+    fold_help_copy (console.alias_data, console.alias_folded, console.alias_filter);
+    console.all_help.reset ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+index_log_trigrams ()
+{
+    console.log_trigrams.clear ();
+    if (console.index_log)
+        for (auto const& i: console.log_indexes)
+        {
+            auto [b, e] = extract_message (console.log_data, i);
+            console.log_trigrams.add (b, e);
+        }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::string
+memory_usage ()
+{
+    auto kib = [] (std::size_t bytes) {
+        return std::to_string ((bytes + 1023) / 1024) + " KiB";
+    };
+    auto help = [] (std::vector<char> const& data, std::vector<help_index> const& indexes) {
+        return data.capacity () + indexes.capacity () * sizeof (help_index);
+    };
+    auto& c = console;
+    return "Log: " + std::to_string (c.log_indexes.size ()) + " records, "
+        + kib (c.log_data.capacity ()) + " text, "
+        + kib (c.log_indexes.capacity () * sizeof (log_index)) + " indexes, "
+        + kib (c.log_filter.memory () + c.log_finder.memory ()) + " filter.\n"
+        + "Help: " + kib (help (c.sse_data, c.sse_indexes) + help (c.gui_data, c.gui_indexes)
+                + help (c.alias_data, c.alias_indexes) + c.completers.memory ()) + ", "
+        + kib (c.sse_filter.memory () + c.gui_filter.memory () + c.alias_filter.memory ()
+                + c.all_help.memory ())
+        + " filter.\n"
+        + "Folded copies: " + kib (c.log_folded.capacity () + c.sse_folded.capacity ()
+                + c.gui_folded.capacity () + c.alias_folded.capacity ()) + ".\n"
+        + "Log index: " + kib (c.log_trigrams.memory ()) + ".";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// The visible records share mostly the same second, so its formatting is cached
+std::string_view
+format_prompt (log_index i, char (&buffer)[prompt_capacity])
+{
+    static std::time_t cached_time = -1;
+    static char stamp[32];
+    static std::size_t stamp_size = 0;
+
+    std::time_t t = i.time;
+    if (t != cached_time)
+    {
+        cached_time = t;
+        auto tm = std::localtime (&t);
+        stamp_size = tm ? std::strftime (stamp, sizeof (stamp), "[%Y-%m-%d %H:%M:%S]", tm) : 0;
+    }
+
+    auto p = std::copy_n (stamp, stamp_size, buffer);
+    p = std::to_chars (p, std::end (buffer), i.counter).ptr;
+    *p++ = i.out ? '>' : '<';
+    *p++ = ' ';
+    return std::string_view (buffer, std::size_t (p - buffer));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Past that much released text, the offsets are numbered again, see log_text#rebase()
+static constexpr std::uint32_t log_rebase_offset = std::uint32_t (1) << 30;
+
+/**
+ * The records are evicted in batches of a 1/16 of the limit, or by whole chunks for the bytes
+ * limit, so that the moves of the indexes are amortized over many appends. The offsets of the
+ * surviving records stay the same, hence the filter caches only lose their fronts. Only once in
+ * a while, after a lot of text was released, the offsets are all moved down.
+ */
+
+void
+evict_log_records (bool archive)
+{
+    auto& indexes = console.log_indexes;
+    std::size_t count = 0;
+
+    if (console.log_max_records && indexes.size () > console.log_max_records)
+        count = indexes.size () - console.log_max_records + console.log_max_records / 16;
 
-    if (!load_settings ())
+    auto capacity = console.log_data.capacity ();
+    if (console.log_max_bytes && capacity > console.log_max_bytes && !indexes.empty ())
+    {
+        auto chunks = (capacity - console.log_max_bytes + log_text::chunk_size - 1)
+                    >> log_text::chunk_bits;
+        auto until = ((indexes.front ().begin >> log_text::chunk_bits) + chunks)
+                    << log_text::chunk_bits;
+        auto it = std::lower_bound (indexes.begin (), indexes.end (), until,
+                [] (log_index const& a, std::size_t b) { return a.begin < b; });
+        count = std::max (count, std::size_t (it - indexes.begin ()));
+    }
+
+    count = std::min (count, indexes.size () - !indexes.empty ());
+    if (!count)
+        return;
+
+    if (archive && console.log_archive)
+        archive_log_records (count);
+
+    indexes.erase (indexes.begin (), indexes.begin () + count);
+    auto kept = indexes.empty () ? console.log_data.end () : indexes.front ().begin;
+    console.log_data.release (kept);
+    console.log_folded.release (kept);
+    console.log_trigrams.drop (count);
+    console.log_filter.drop (count);
+    console.log_finder.drop (count);
+    console.current_history = std::max (0, console.current_history - int (count));
+
+    if (console.log_data.released () >= log_rebase_offset)
+    {
+        auto shift = console.log_data.rebase ();
+        console.log_folded.rebase ();
+        for (auto& i: indexes)
+            i.begin -= shift;
+        console.log_filter.rebase (shift);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Parses "HH:MM[:SS]", "YYYY-MM-DD" or "YYYY-MM-DDTHH:MM[:SS]" as local time, on the date of
+ * the given time if it is not written. The result is the inclusive range of seconds it spans.
+ * Otherwise "-<number><s|m|h|d>" is the second that long before the given time.
+ */
+
+static bool
+parse_time_point (std::string_view s, std::uint32_t now, std::uint32_t& first, std::uint32_t& last)
+{
+    if (s.starts_with ('-'))
+    {
+        std::uint32_t n = 0;
+        auto [p, ec] = std::from_chars (s.data () + 1, s.data () + s.size (), n);
+        if (ec != std::errc () || p + 1 != s.data () + s.size ())
+            return false;
+        std::uint64_t unit = 0;
+        switch (*p)
+        {
+            case 's': unit = 1; break;
+            case 'm': unit = 60; break;
+            case 'h': unit = 60 * 60; break;
+            case 'd': unit = 24 * 60 * 60; break;
+            default: return false;
+        }
+        first = last = std::uint32_t (now - std::min<std::uint64_t> (now, n * unit));
+        return true;
+    }
+
+    std::time_t t = now;
+    auto ptm = std::localtime (&t);
+    if (!ptm)
         return false;
+    std::tm tm = *ptm;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+
+    auto number = [&s] (int& v, char sep)
+    {
+        auto [p, ec] = std::from_chars (s.data (), s.data () + s.size (), v);
+        if (ec != std::errc () || (p != s.data () + s.size () && *p != sep))
+            return false;
+        s.remove_prefix (std::min (s.size (), std::size_t (p - s.data ()) + 1));
+        return true;
+    };
 
-    if (!setup_render ())
+    int* unit = &tm.tm_mday;
+    if (s.size () >= 10 && s[4] == '-')
+    {
+        if (!number (tm.tm_year, '-') || !number (tm.tm_mon, '-') || !number (tm.tm_mday, 'T'))
+            return false;
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+    }
+    if (!s.empty ())
+    {
+        if (!number (tm.tm_hour, ':') || s.empty () || !number (tm.tm_min, ':'))
+            return false;
+        unit = &tm.tm_min;
+        if (!s.empty ())
+        {
+            if (!number (tm.tm_sec, ' '))
+                return false;
+            unit = &tm.tm_sec;
+        }
+    }
+
+    auto begin = std::mktime (&tm);
+    tm.tm_isdst = -1;
+    ++*unit;
+    auto end = std::mktime (&tm);
+    if (begin < 0 || end <= begin)
         return false;
+    first = std::uint32_t (begin);
+    last = std::uint32_t (end - 1);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::string
+log_query::parse (std::string_view text, std::uint32_t now)
+{
+    *this = log_query {};
+    std::string rest;
+
+    auto range = [] (std::string_view v, auto&& point, std::uint32_t& first, std::uint32_t& last)
+    {
+        auto dots = v.find ("..");
+        auto a = v.substr (0, dots);
+        auto b = dots == std::string_view::npos ? a : v.substr (dots + 2);
+        std::uint32_t unused = 0;
+        return (a.empty () || point (a, first, unused)) && (b.empty () || point (b, unused, last))
+            && !(a.empty () && b.empty ());
+    };
+    auto time = [now] (std::string_view v, std::uint32_t& first, std::uint32_t& last) {
+        return parse_time_point (v, now, first, last);
+    };
+    auto counter = [] (std::string_view v, std::uint32_t& first, std::uint32_t& last) {
+        auto [p, ec] = std::from_chars (v.data (), v.data () + v.size (), first);
+        last = first;
+        return ec == std::errc () && p == v.data () + v.size ();
+    };
+
+    // Not within the quoted phrases of the text query
+    bool quoted = false;
+    for (std::size_t b = 0, e = 0; b < text.size (); b = e)
+    {
+        e = std::min (text.find (' ', b + 1), text.size ());
+        auto word = trimmed_both (text.substr (b, e - b), ' ');
+        std::string_view w (word);
+        bool plain = !quoted && w.find ('"') == w.npos;
+        quoted ^= std::count (w.begin (), w.end (), '"') % 2;
+
+        // A relative time alone is since then
+        bool taken = false;
+        if (plain)
+        {
+            if (w.starts_with ("time:-") && w.find ("..") == w.npos)
+                taken = range (std::string (w.substr (5)) + "..", time, time_first, time_last);
+            else if (w.starts_with ("time:"))
+                taken = range (w.substr (5), time, time_first, time_last);
+            else if (w.starts_with ("counter:"))
+                taken = range (w.substr (8), counter, counter_first, counter_last);
+        }
+
+        // The older "dir:in" and "dir:out" are the same as the "in:" and "out:" query terms, so
+        // that they combine the same with the other terms
+        auto d = w.substr (w.starts_with ('-'));
+        if (plain && (d == "dir:in" || d == "dir:out"))
+        {
+            auto part = std::string (text.substr (b, e - b));
+            part.erase (part.find ("dir:"), 4);
+            rest.append (part).append (":");
+        }
+        else if (!taken)
+            rest.append (text.substr (b, e - b));
+    }
+    return rest;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+log_query::select (log_index const* first, log_index const* last, std::vector<log_index>& dst) const
+{
+    bool ordered = std::is_sorted (first, last,
+            [] (log_index const& a, log_index const& b) { return a.time < b.time; });
+    if (ordered)
+    {
+        first = std::partition_point (first, last,
+                [this] (log_index const& i) { return i.time < time_first; });
+        last = std::partition_point (first, last,
+                [this] (log_index const& i) { return i.time <= time_last; });
+    }
+
+    if (ordered && counter_first == 0 && counter_last == std::uint32_t (-1))
+    {
+        dst.insert (dst.end (), first, last);
+        return;
+    }
+    std::copy_if (first, last, std::back_inserter (dst), [this] (log_index const& i)
+    {
+        return i.time >= time_first && i.time <= time_last
+            && i.counter >= counter_first && i.counter <= counter_last;
+    });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+update_log_filter ()
+{
+    // All of the log stays shown, while the text is only looked up
+    if (console.log_find)
+    {
+        if (console.log_scope.any ())
+        {
+            console.log_scope = log_query {};
+            console.log_filter.scope (nullptr);
+        }
+        console.log_filter.update ("");
+        console.log_finder.find (console.log_filter.buffer.data ());
+        return;
+    }
+
+    auto now = console.log_indexes.empty ()
+        ? std::uint32_t (std::time (nullptr)) : console.log_indexes.back ().time;
+
+    log_query q;
+    auto text = q.parse (console.log_filter.buffer.data (), now);
+    if (!(q == console.log_scope))
+    {
+        console.log_scope = q;
+        if (q.any ())
+            console.log_filter.scope ([q] (auto first, auto last, auto& dst) {
+                q.select (first, last, dst);
+            });
+        else
+            console.log_filter.scope (nullptr);
+    }
+    console.log_filter.update (text.c_str ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+find_log_record (bool backward)
+{
+    if (backward ? console.log_finder.previous () : console.log_finder.next ())
+        console.scroll_to_found = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// As the folded string_view compare, so bytes over 127 (of UTF-8) come after the ASCII ones
+
+static bool
+folded_less (std::string_view a, std::string_view b)
+{
+    return std::lexicographical_compare (a.begin (), a.end (), b.begin (), b.end (),
+            [] (char x, char y) {
+                return std::uint8_t (fold_ascii (x)) < std::uint8_t (fold_ascii (y));
+            });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Sorted by the folded names, then as written, so the same ones are next to each other
+
+void
+completion_names::assign (std::vector<std::string> const& names)
+{
+    text.clear ();
+    folded.clear ();
+    index.clear ();
+    for (auto const& n: names)
+        if (!n.empty ())
+        {
+            index.push_back (entry {
+                    std::uint32_t (text.size ()), std::uint32_t (n.size ()), fuzzy_mask (n) });
+            text.append (n).push_back ('\0');
+        }
+    std::sort (index.begin (), index.end (), [this] (entry const& a, entry const& b) {
+        auto x = std::string_view (&text[a.offset], a.length);
+        auto y = std::string_view (&text[b.offset], b.length);
+        return folded_less (x, y) || (!folded_less (y, x) && x < y);
+    });
+    index.erase (std::unique (index.begin (), index.end (), [this] (auto const& a, auto const& b) {
+        return std::string_view (&text[a.offset], a.length)
+            == std::string_view (&text[b.offset], b.length);
+    }), index.end ());
+    compact ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+completion_names::compact ()
+{
+    std::string t;
+    t.reserve (text.size ());
+    for (auto& e: index)
+    {
+        auto n = std::string_view (&text[e.offset], e.length + 1);
+        e.offset = std::uint32_t (t.size ());
+        t.append (n);
+    }
+    text.swap (t);
+    folded.resize (text.size ());
+    std::transform (text.begin (), text.end (), folded.begin (), fold_ascii);
+    ++revisions;
+}
 
-    if (!load_help_files ())
+//--------------------------------------------------------------------------------------------------
+
+std::pair<std::size_t, std::size_t>
+completion_names::folded_range (std::string_view name) const
+{
+    auto folded_name = [this] (entry const& e) {
+        return std::string_view (&folded[e.offset], e.length);
+    };
+    auto first = std::partition_point (index.begin (), index.end (),
+            [&] (entry const& e) { return folded_less (folded_name (e), name); });
+    auto last = std::partition_point (first, index.end (),
+            [&] (entry const& e) { return !folded_less (name, folded_name (e)); });
+    return { std::size_t (first - index.begin ()), std::size_t (last - index.begin ()) };
+}
+
+bool
+completion_names::contains (std::string_view name) const
+{
+    auto [i, end] = folded_range (name);
+    for (; i < end; ++i)
+        if (this->name (i) == name)
+            return true;
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+completion_names::insert (std::string_view name)
+{
+    if (name.empty () || contains (name))
         return false;
 
-    load_log_file (plugin_directory () + "default.log");
+    auto [i, end] = folded_range (name);
+    while (i < end && this->name (i) < name)
+        ++i;
+    index.insert (index.begin () + i, entry {
+            std::uint32_t (text.size ()), std::uint32_t (name.size ()), fuzzy_mask (name) });
+    text.append (name).push_back ('\0');
+    std::transform (name.begin (), name.end (), std::back_inserter (folded), fold_ascii);
+    folded.push_back ('\0');
+    ++revisions;
     return true;
 }
 
+/// Rare, as of an alias deleted, so the pools are made again without it
+
+bool
+completion_names::erase (std::string_view name)
+{
+    auto [i, end] = folded_range (name);
+    for (; i < end; ++i)
+        if (this->name (i) == name)
+        {
+            index.erase (index.begin () + i);
+            compact ();
+            return true;
+        }
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::pair<std::size_t, std::size_t>
+completion_names::prefixed (std::string_view prefix) const
+{
+    std::string p (prefix);
+    std::transform (p.begin (), p.end (), p.begin (), fold_ascii);
+    auto name = [this] (entry const& e) {
+        return std::string_view (&folded[e.offset], e.length);
+    };
+    auto first = std::partition_point (index.begin (), index.end (),
+            [&] (entry const& e) { return name (e) < p; });
+    auto last = std::partition_point (first, index.end (),
+            [&] (entry const& e) { return name (e).starts_with (p); });
+    return { std::size_t (first - index.begin ()), std::size_t (last - index.begin ()) };
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const char*
+text_completion::match (std::size_t i) const
+{
+    return console.completers[fuzzy.empty () ? i : fuzzy[i]];
+}
+
+const char*
+text_completion::complete (std::string_view text, int cursor, int& start, int& count)
+{
+    auto const& names = console.completers;
+
+    // Allows scrolling through different matches
+    if (prev_uid == hash (text) && last - first > 1 && names_revision == names.revision ())
+    {
+        if (++current == last)
+            current = first;
+        start = prev_start, count = prev_len;
+        prev_len = int (std::strlen (match (current))) + 1;
+        return match (current);
+    }
+
+    // Find the start & end of the word
+    const char* word_end = text.data () + cursor;
+    const char* word_begin = word_end;
+    for (; word_end < text.data () + text.size (); ++word_end)
+        if (*word_end == ' ')
+            break;
+    for (; word_begin > text.data (); --word_begin)
+        if (word_begin[-1] == ' ')
+            break;
+
+    // Small non-zero text is ignored as autocompletion - no reason
+    fuzzy.clear ();
+    first = last = current = 0;
+    names_revision = names.revision ();
+    if (word_end - word_begin < 2)
+        return nullptr;
+
+    // Find matches
+    std::tie (first, last) = names.prefixed (std::string_view (word_begin, word_end - word_begin));
+
+    // Otherwise likely mistyped, so the closest ones, also after a reference, as "ply.addtem"
+    if (first == last)
+    {
+        auto dot = std::find (std::make_reverse_iterator (word_end),
+                std::make_reverse_iterator (word_begin), '.').base ();
+        if (dot > word_begin + 1)
+            word_begin = dot;
+        if (word_end - word_begin < 2)
+            return nullptr;
+        fuzzy_pattern pattern (std::string_view (word_begin, word_end - word_begin));
+        fuzzy_top top (fuzzy_completions);
+        fuzzy_pattern::match m;
+        for (std::size_t i = 0; i < names.size (); ++i)
+            if (pattern.score (names.name (i), names.mask (i), m))
+                top.push (m.score, names.name (i).size (), std::uint32_t (i));
+        for (auto const& e: top.take ())
+            fuzzy.push_back (e.key);
+        first = 0;
+        last = fuzzy.size ();
+    }
+
+    if (first == last)
+        return nullptr;
+
+    current = first;
+    start = prev_start = int (word_begin - text.data ());
+    count = int (word_end - word_begin);
+    prev_len = int (std::strlen (match (current))) + 1;
+    return match (current);
+}
+
+void
+text_completion::completed (std::string_view text)
+{
+    prev_uid = hash (text);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// The text, its folded copy (maybe empty) and the records of the help, as in help_index#store
+
+static auto
+help_store (std::uint32_t store)
+{
+    auto& c = console;
+    return store == 0 ? std::tie (c.sse_data, c.sse_folded, c.sse_indexes)
+         : store == 1 ? std::tie (c.gui_data, c.gui_folded, c.gui_indexes)
+         :              std::tie (c.alias_data, c.alias_folded, c.alias_indexes);
+}
+
+static constexpr std::uint32_t help_stores = 3, alias_store = 2;
+
+/// Of a record, as the store and the position there
+static constexpr unsigned help_key_bits = 24;
+
+//--------------------------------------------------------------------------------------------------
+
+void
+help_search::init ()
+{
+    buffer.clear ();
+    buffer.resize (256, '\0');
+    reset ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+help_search::index_names (std::uint32_t store, std::uint32_t position,
+        std::vector<name_entry>& dst)
+{
+    // The names follow each other after a space, see load_help_file()
+    auto [first, last, b, d, e] = extract_message (
+            std::get<0> (help_store (store)), std::get<2> (help_store (store))[position]);
+    for (auto p = first; p != last; )
+    {
+        auto q = std::find (p, last, ' ');
+        if (q != p)
+        {
+            dst.push_back (name_entry { std::uint32_t (names.size ()), std::uint32_t (q - p),
+                    store << help_key_bits | position, std::uint32_t (p - first),
+                    fuzzy_mask (std::string_view (p, q - p)) });
+            std::transform (p, q, std::back_inserter (names), fold_ascii);
+        }
+        p = q == last ? q : q + 1;
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 
 void
-record_log_message (bool outgoing, std::string const& msg)
+help_search::reset ()
 {
-    std::stringstream ss;
+    names.clear ();
+    index.clear ();
+    for (std::uint32_t s = 0; s < help_stores; ++s)
+        for (std::uint32_t i = 0, n = std::uint32_t (std::get<2> (help_store (s)).size ());
+                i < n; ++i)
+            index_names (s, i, index);
+    std::sort (index.begin (), index.end (), [this] (auto const& a, auto const& b) {
+        return names.compare (a.offset, a.length, names, b.offset, b.length) < 0;
+    });
 
-    auto now_c = std::time (nullptr);
-    auto loc_c = std::localtime (&now_c);
-    ss << std::put_time (loc_c, "[%Y-%m-%d %H:%M:%S]");
+    matcher = nullptr;
+    update (buffer.empty () ? "" : buffer.data ());
+}
 
-    if (outgoing)
-        ss << ++console.counter_out << '>';
+//--------------------------------------------------------------------------------------------------
+
+void
+help_search::alias_added ()
+{
+    std::vector<name_entry> added;
+    index_names (alias_store, std::uint32_t (console.alias_indexes.size () - 1), added);
+    for (auto const& a: added)
+        index.insert (std::upper_bound (index.begin (), index.end (), a,
+                    [this] (auto const& a, auto const& b) {
+                        return names.compare (a.offset, a.length, names, b.offset, b.length) < 0;
+                    }), a);
+
+    matcher = nullptr;
+    update (buffer.empty () ? "" : buffer.data ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// The names of a record are next to each other in #names, so these are taken out as a whole
+
+void
+help_search::alias_erased (std::uint32_t position)
+{
+    auto key = alias_store << help_key_bits | position;
+    std::uint32_t first = std::uint32_t (names.size ()), last = 0;
+    for (auto const& n: index)
+        if (n.key == key)
+            first = std::min (first, n.offset), last = std::max (last, n.offset + n.length);
+
+    index.erase (std::remove_if (index.begin (), index.end (),
+                [key] (name_entry const& n) { return n.key == key; }), index.end ());
+    if (first < last)
+        names.erase (first, last - first);
+    for (auto& n: index)
+    {
+        if (n.offset >= last)
+            n.offset -= last - first;
+        if (n.key >> help_key_bits == alias_store && n.key > key)
+            --n.key;
+    }
+
+    matcher = nullptr;
+    update (buffer.empty () ? "" : buffer.data ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<char> const&
+help_search::source_data (help_index i) const
+{
+    return std::get<0> (help_store (i.store));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+help_search::update (const char* text)
+{
+    auto query = std::make_shared<text_query const> (text);
+    if (!query->error ().empty () || (matcher && matcher->key () == query->key ()))
+        return;
+
+    // The previous result holds all of the new one, e.g. one more character typed
+    std::vector<std::uint32_t> input;
+    if (matcher && query->implies (*matcher))
+        input.swap (matched);
     else
-        ss << ++console.counter_in  << '<';
-    ss << ' ';
+        for (std::uint32_t s = 0; s < help_stores; ++s)
+            for (std::uint32_t i = 0, n = std::uint32_t (std::get<2> (help_store (s)).size ());
+                    i < n; ++i)
+                input.push_back (s << help_key_bits | i);
 
-    log_index ndx;
-    ndx.out = outgoing;
-    ndx.begin = static_cast<std::uint32_t> (console.log_data.size ());
-    ndx.mid = std::uint32_t (ss.str ().size ());
+    matcher = std::move (query);
+    results.clear ();
+    spans.clear ();
+    matched.clear ();
+    ++revisions;
 
-    ss << trimmed_both (msg, ' ');
-    auto str = ss.str ();
-    ndx.end = std::uint32_t (str.size ());
+    auto record = [] (std::uint32_t key)
+    {
+        auto i = std::get<2> (help_store (key >> help_key_bits))
+            [key & ((1u << help_key_bits) - 1)];
+        i.store = key >> help_key_bits;
+        return i;
+    };
+    auto const& q = *matcher;
+    if (q.matches_all ())
+    {
+        for (auto k: input)
+            results.push_back (record (k));
+        spans.resize (results.size ());
+        matched.swap (input);
+        return;
+    }
 
-    console.log_indexes.push_back (ndx);
-    console.log_data.insert (console.log_data.end (), str.begin (), str.end ());
+    // Out of the index, the shorter names first as likely the closest ones
+    std::vector<name_entry const*> named;
+    if (auto literal = q.literal (); !literal.empty ())
+    {
+        auto i = std::lower_bound (index.cbegin (), index.cend (), literal,
+                [this] (name_entry const& a, std::string_view b) {
+                    return std::string_view (names).substr (a.offset, a.length) < b;
+                });
+        for (; i != index.cend ()
+                && std::string_view (names).substr (i->offset, i->length).starts_with (literal);
+                ++i)
+            if (std::binary_search (input.cbegin (), input.cend (), i->key))
+                named.push_back (&*i);
+        std::stable_sort (named.begin (), named.end (), [] (auto a, auto b) {
+            return a->length < b->length;
+        });
+    }
+
+    std::vector<std::uint32_t> ranked;  // Sorted, of the named records which hold the query
+    for (auto n: named)
+    {
+        auto key = n->key;
+        if (std::binary_search (ranked.cbegin (), ranked.cend (), key))
+            continue;
+        auto i = record (key);
+        auto [data, folded, indexes] = help_store (i.store);
+        auto [first, p, b, d, last] = extract_message (data, i);
+        if (!q.contains (first, last, 0))
+            continue;
+        ranked.insert (std::upper_bound (ranked.begin (), ranked.end (), key), key);
+        results.push_back (i);
+        spans.push_back (match_span {
+                std::uint16_t (n->within), std::uint16_t (q.literal ().size ()) });
+    }
+
+    // The rest by the part where the query was found, in the order of the help
+    std::vector<help_index> parts[3];
+    std::vector<match_span> parts_spans[3];
+    for (auto key: input)
+    {
+        if (std::binary_search (ranked.cbegin (), ranked.cend (), key))
+        {
+            matched.push_back (key);
+            continue;
+        }
+        auto i = record (key);
+        auto [data, folded, indexes] = help_store (i.store);
+        bool fold = console.fold_copies && folded.size () == data.size ();
+        auto [name, params, brief, details, end] = extract_message (fold ? folded : data, i);
+
+        match_span span;
+        if (!(fold ? q.contains_folded (name, end, 0, span) : q.contains (name, end, 0, span)))
+            continue;
+        auto at = name + span.offset;
+        int part = !span.length ? 2 : at < params ? 0 : at >= brief && at < details ? 1 : 2;
+        matched.push_back (key);
+        parts[part].push_back (i);
+        parts_spans[part].push_back (span);
+    }
+    for (int p = 0; p < 3; ++p)
+    {
+        results.insert (results.end (), parts[p].begin (), parts[p].end ());
+        spans.insert (spans.end (), parts_spans[p].begin (), parts_spans[p].end ());
+    }
+
+    // Last the closest of the names which do not hold the word, but have its characters in order
+    auto word = q.word ();
+    if (word.size () < 2)
+        return;
+    fuzzy_pattern pattern (word);
+    fuzzy_top top (fuzzy_help_results);
+    fuzzy_pattern::match m;
+    auto name = [&record] (name_entry const& e)   // As written, for the camel case to score
+    {
+        auto i = record (e.key);
+        return std::string_view (&std::get<0> (help_store (i.store))[i.begin + e.within], e.length);
+    };
+    // A record named more than once competes once, with the best of its names, so that the
+    // others would not take its places and then be dropped
+    struct candidate
+    {
+        int score;
+        std::uint32_t length, key, n;
+    };
+    std::vector<candidate> candidates;
+    for (std::size_t n = 0; n < index.size (); ++n)
+    {
+        auto const& e = index[n];
+        if ((e.mask | pattern.mask ()) == e.mask && pattern.score (name (e), e.mask, m)
+                && !std::binary_search (matched.cbegin (), matched.cend (), e.key))
+            candidates.push_back (candidate { m.score, e.length, e.key, std::uint32_t (n) });
+    }
+    std::sort (candidates.begin (), candidates.end (),
+            [] (candidate const& a, candidate const& b) {
+        return std::tie (a.key, b.score, a.length, a.n) < std::tie (b.key, a.score, b.length, b.n);
+    });
+    candidates.erase (std::unique (candidates.begin (), candidates.end (),
+            [] (candidate const& a, candidate const& b) { return a.key == b.key; }),
+            candidates.end ());
+    std::sort (candidates.begin (), candidates.end (),
+            [] (candidate const& a, candidate const& b) { return a.n < b.n; });
+    for (auto const& c: candidates)
+        top.push (c.score, c.length, c.n);
+
+    for (auto const& t: top.take ())
+    {
+        auto const& e = index[t.key];
+        pattern.score (name (e), e.mask, m);
+        results.push_back (record (e.key));
+        spans.push_back (match_span {
+                std::uint16_t (e.within + m.offset), std::uint16_t (m.length) });
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t
+help_search::memory () const
+{
+    return names.capacity () + index.capacity () * sizeof (name_entry)
+        + results.capacity () * sizeof (help_index) + spans.capacity () * sizeof (match_span)
+        + matched.capacity () * sizeof (std::uint32_t);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-/// Bugged function in mainstream
-/// @see https://github.com/ocornut/imgui/issues/3454
+void
+execute_command (std::string cmd)
+{
+    trim_both (cmd, ' ');
+    if (cmd.empty ())
+        return;
+
+    record_log_message (true, cmd);
+
+    std::string result;
+    if (cmd[0] == '/')
+    {
+        std::string param;
+        auto match_param = [&cmd, &param] (std::string_view txt)
+        {
+            if (txt.size () <= cmd.size () && cmd.rfind (txt, 0) == 0)
+            {
+                param = cmd.substr (txt.size ());
+                trim_begin (param, ' ');
+                return true;
+            }
+            return false;
+        };
+
+        if (match_param ("/run "))
+        {
+            if (load_run_file (plugin_directory () + param) && !console.commands.empty ())
+                platform::update_timer (console.execution_delay);
+            else result = "Unable to run script file.";
+        }
+        else if (cmd == "/run-enough")
+        {
+            console.commands.clear ();
+            platform::update_timer (0);
+        }
+        else if (cmd == "/copy")
+            console.log_to_clipboard = true;
+        else if (cmd == "/clear")
+        {
+            console.log_data.clear ();
+            console.log_folded.clear ();
+            console.log_trigrams.clear ();
+            console.log_indexes.clear ();
+            console.log_filter.reset ();
+            console.log_finder.reset ();
+            console.counter_in = console.counter_out = 0;
+            console.current_history = 0;
+        }
+        else if (match_param ("/load "))
+        {
+            if (load_log_file (plugin_directory () + param + ".log"))
+            {
+                console.current_history = 0;
+                console.log_filter.reset ();
+                console.log_finder.reset ();
+            }
+            else result = "Unable to load log file.";
+        }
+        else if (match_param ("/save "))
+            save_log_file (plugin_directory () + param + ".log");
+
+        else if (match_param ("/async "))
+        {
+            std::error_code ec;
+            std::filesystem::remove (plugin_directory () + "async", ec);
+            if (!platform::create_process (param, plugin_directory () + "async"))
+                result = "Unable to create a process.";
+        }
+        else if (cmd == "/async-read")
+        {
+            std::ifstream fi (plugin_directory () + "async");
+            if (fi.is_open ())
+            {
+                std::stringstream ss;
+                ss << fi.rdbuf ();
+                result = ss.str ();
+            }
+            else result = "Unable to read file.";
+        }
+
+        else if (match_param ("/filter-alias")
+                && param.size ()+1 < console.alias_filter.buffer.size ())
+            *std::copy (param.cbegin (), param.cend (),
+                    console.alias_filter.buffer.begin ()) = '\0';
+        else if (match_param ("/filter-sse")
+                && param.size ()+1 < console.sse_filter.buffer.size ())
+            *std::copy (param.cbegin (), param.cend (), console.sse_filter.buffer.begin ()) = '\0';
+        else if (match_param ("/filter-help")
+                && param.size ()+1 < console.all_help.buffer.size ())
+        {
+            *std::copy (param.cbegin (), param.cend (), console.all_help.buffer.begin ()) = '\0';
+            console.all_help.update (console.all_help.buffer.data ());
+        }
+        else if (match_param ("/filter-gui")
+                && param.size ()+1 < console.gui_filter.buffer.size ())
+            *std::copy (param.cbegin (), param.cend (), console.gui_filter.buffer.begin ()) = '\0';
+        else if (match_param ("/filter")
+                && param.size ()+1 < console.log_filter.buffer.size ())
+        {
+            console.log_find = false;
+            *std::copy (param.cbegin (), param.cend (), console.log_filter.buffer.begin ()) = '\0';
+        }
+        else if (match_param ("/find")
+                && param.size ()+1 < console.log_filter.buffer.size ())
+        {
+            console.log_find = true;
+            *std::copy (param.cbegin (), param.cend (), console.log_filter.buffer.begin ()) = '\0';
+            update_log_filter ();
+            find_log_record (true);
+            // Past this very command, as it holds the text too
+            if (console.log_finder.found () + 1 == console.log_indexes.size ())
+                find_log_record (true);
+        }
+
+        else if (cmd == "/memory")
+            result = memory_usage ();
+
+        else if (match_param ("/alias-delete ") && param.size () > 1)
+        {
+            param = '.' + param;
+            bool deleted = false;
+            for (std::size_t i = 0, ni = console.alias_indexes.size (); i < ni; ++i)
+            {
+                auto [n, p, b, d, e] =
+                    extract_message (console.alias_data, console.alias_indexes[i]);
+
+                std::string name (n, p);
+                if (param == name)
+                {
+                    console.alias_data.erase (
+                            console.alias_data.begin () + (n - &console.alias_data[0]),
+                            console.alias_data.begin () + (e - &console.alias_data[0]));
+                    console.alias_indexes.erase (console.alias_indexes.begin () + i);
+                    auto position = std::uint32_t (i);
+                    for (ni -= 1; i < ni; ++i)
+                        console.alias_indexes[i].begin -= e - n;
+                    fold_help_copy (console.alias_data, console.alias_folded,
+                            console.alias_filter);
+                    console.all_help.alias_erased (position);
+                    console.alias_filter.reset ();
+                    console.alias_filter.update (console.alias_filter.buffer.data ());
+
+                    deleted = console.completers.erase (name);
+
+                    save_aliases ();
+                    break;
+                }
+            }
+            if (!deleted)
+                result = "Unable to delete an alias.";
+        }
+        else if (match_param ("/alias "))
+        {
+            auto old_size = console.completers.size ();
+            if (auto i = param.find (' '); i != std::string::npos && i+1 < param.size ())
+            {
+                auto n = '.' + param.substr (0, i);
+                auto b = trim_both (param.substr (i), ' ');
+                if (b.size () && !console.completers.contains (n))
+                {
+                    help_index ndx;
+                    ndx.begin = console.alias_data.size ();
+                    std::string p;
+                    for (std::size_t i = 0, n = b.size (); i < n; ++i)
+                        if (auto j = b.find ('<', i); j != std::string::npos)
+                            if (auto k = b.find ('>', j+1); k != std::string::npos)
+                                p += b.substr (j, k-j+1) + " ", i = k;
+                    trim_end (p, ' ');
+                    ndx.params = n.size ();
+                    ndx.brief = p.size ();
+                    ndx.details = b.size ();
+                    ndx.end = 0;
+
+                    console.alias_data.insert (console.alias_data.end (), n.cbegin (), n.cend ());
+                    console.alias_data.insert (console.alias_data.end (), p.cbegin (), p.cend ());
+                    console.alias_data.insert (console.alias_data.end (), b.cbegin (), b.cend ());
+                    console.alias_indexes.push_back (ndx);
+                    console.completers.insert (n);
+                    if (console.fold_copies)
+                        std::transform (console.alias_data.cbegin () + ndx.begin,
+                                console.alias_data.cend (),
+                                std::back_inserter (console.alias_folded), fold_ascii);
+                    console.all_help.alias_added ();
+
+                    // Appended, so only the new alias gets matched
+                    console.alias_filter.update (console.alias_filter.buffer.data ());
+                    save_aliases ();
+                }
+            }
+            if (old_size == console.completers.size ())
+                result = "Unable to create an alias.";
+        }
+        else result = "Unknown GUI command.";
+
+        cmd.clear ();
+    }
+    else if (cmd[0] == '.' && cmd.size () > 1)
+    {
+        auto actuals = split (cmd, ' ');
+        std::string brief, params;
+
+        for (auto const& ndx: console.alias_indexes)
+            if (auto [n, p, b, d, e] = extract_message (console.alias_data, ndx);
+                    actuals[0] == std::string_view (n, p-n))
+            {
+                params.assign (p, b);
+                brief.assign (b, d);
+                break;
+            }
+
+        if (params.size ())
+        {
+            std::reverse (actuals.begin (), actuals.end ());
+            actuals.pop_back ();
+
+            if (actuals.size () != split (params, ' ').size ())
+                brief.clear ();
+            else
+            {
+                for (std::size_t i = 0; i < brief.size () && actuals.size (); ++i)
+                    if (auto j = brief.find ('<', i); j != std::string::npos)
+                        if (auto k = brief.find ('>', j+1); k != std::string::npos)
+                        {
+                            brief.replace (j, k-j+1, actuals.back ());
+                            i = j + actuals.back ().size ();
+                            actuals.pop_back ();
+                        }
+            }
+        }
+
+        if (brief.size ())
+            cmd = brief;
+        else result = "Unable to execute an alias.";
+    }
+
+    if (result.size ())
+    {
+        record_log_message (false, result);
+        result.clear ();
+        cmd.clear ();
+    }
+
+    if (cmd.size ())
+    {
+        skyrim_log::last_message ("");
+        skyrim_console::execute (cmd);
+        result = skyrim_log::last_message ();
+        if (result.size ())
+            record_log_message (false, result);
+    }
+
+    console.current_history = console.log_indexes.size ();
+    update_log_filter ();
+    console.scroll_to_bottom = true;
+}
+
+//--------------------------------------------------------------------------------------------------
 
 void
-ImGuiInputTextCallbackData_DeleteChars (ImGuiInputTextCallbackData* self, int pos, int bytes_count)
+execute_queued_command ()
 {
-    Expects (pos + bytes_count <= self->BufTextLen);
-    char* dst = self->Buf + pos;
-    const char* src = self->Buf + pos + bytes_count;
-    while (char c = *src++)
-        *dst++ = c;
-    *dst = '\0';
+    if (console.commands.empty ())
+    {
+        platform::update_timer (0);
+        return;
+    }
 
-    if (self->CursorPos >= pos + bytes_count)
-        self->CursorPos -= bytes_count;
-    else if (self->CursorPos >= pos)
-        self->CursorPos = pos;
-    self->SelectionStart = self->SelectionEnd = self->CursorPos;
-    self->BufDirty = true;
-    self->BufTextLen -= bytes_count;
+    // Popped first, as a /run command will replace the queue
+    auto cmd = std::move (console.commands.back ());
+    console.commands.pop_back ();
+    execute_command (std::move (cmd));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -23,36 +23,238 @@
  * @ingroup Core
  *
  * @details
+ * Only the headless core lives here: log & help storage, filtering, command processing and the
+ * file formats. Nothing in it should touch ImGui or Windows, see render.hpp and platform.hpp.
  */
 
 #ifndef SSE_CONSOLE_HPP
 #define SSE_CONSOLE_HPP
 
-#include <utils/imgui.hpp>
+#include "search.hpp"
+#include "query.hpp"
+#include "ordinals.hpp"
+#include "trigram.hpp"
+#include "worker.hpp"
+#include <utils/plugin.hpp>
 #include <utils/misc.hpp>
 #include <vector>
+#include <deque>
+#include <list>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <cctype>
 #include <filesystem>
+#include <functional>
+#include <atomic>
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Append-only storage of the log text in fixed size chunks.
+ *
+ * Growing never moves the already stored text, so there are no copies of the whole log on append
+ * and the pointers to it stay valid until #clear() or #release(). A record never spans two chunks,
+ * so it can be addressed with a single offset as if the chunks were one buffer, with few unused
+ * bytes at their ends. Hence, a record can't be larger than #chunk_size. Releasing the oldest
+ * chunks keeps the offsets of the rest as they are.
+ *
+ * Copies share the chunks, which live as long as any copy refers to them. So a copy is a cheap
+ * snapshot for another thread to read the records stored so far, while this one goes on appending.
+ */
+
+class log_text
+{
+public:
+
+    static constexpr unsigned chunk_bits = 22;
+    static constexpr std::size_t chunk_size = std::size_t (1) << chunk_bits;
+
+    /// Truncated to #chunk_size, returning the offset of the stored text
+    std::uint32_t append (std::string_view text)
+    {
+        auto n = std::min (text.size (), chunk_size);
+        std::copy_n (text.data (), n, prepare (n));
+        return commit (n);
+    }
+
+    /// Room for writing in place up to the given size (truncated to #chunk_size)
+    char* prepare (std::size_t n)
+    {
+        if (chunks.empty () || used + std::min (n, chunk_size) > chunk_size)
+        {
+            chunks.push_back (std::make_shared_for_overwrite<char[]> (chunk_size));
+            used = 0;
+        }
+        return chunks.back ().get () + used;
+    }
+
+    /// Keeps that much of what was written after #prepare(), returning its offset
+    std::uint32_t commit (std::size_t n)
+    {
+        auto offset = end ();
+        used += n;
+        return offset;
+    }
+
+    char const* data (std::uint32_t offset) const {
+        return chunks[(offset >> chunk_bits) - base].get () + (offset & (chunk_size - 1));
+    }
+
+    char* data (std::uint32_t offset) {
+        return chunks[(offset >> chunk_bits) - base].get () + (offset & (chunk_size - 1));
+    }
+
+    /// Same chunks and offsets as the other, to be written in place, e.g. a copy made otherwise
+    void mirror (log_text const& other)
+    {
+        chunks.resize (other.chunks.size ());
+        for (auto& c: chunks)
+            if (!c)
+                c = std::make_shared_for_overwrite<char[]> (chunk_size);
+        used = other.used;
+        base = other.base;
+    }
+
+    /// Where the next #append() would go, if it fits in the last chunk
+    std::uint32_t end () const {
+        return std::uint32_t (((base + chunks.size () - !chunks.empty ()) << chunk_bits) + used);
+    }
+
+    /// Frees the chunks entirely before the given offset, except the last one
+    void release (std::uint32_t offset)
+    {
+        auto n = std::min ((offset >> chunk_bits) - base, chunks.size () - !chunks.empty ());
+        chunks.erase (chunks.begin (), chunks.begin () + n);
+        base += n;
+    }
+
+    /// Where the first kept chunk starts, i.e. how much was released so far
+    std::uint32_t released () const {
+        return std::uint32_t (base << chunk_bits);
+    }
+
+    /// Numbers the offsets from the first kept chunk again, so they don't wrap around after 4 GiB
+    /// were ever appended, returning by how much they went down
+    std::uint32_t rebase ()
+    {
+        auto shift = released ();
+        base = 0;
+        return shift;
+    }
+
+    void clear ()
+    {
+        chunks.clear ();
+        used = 0;
+        base = 0;
+    }
+
+    void swap (log_text& other)
+    {
+        chunks.swap (other.chunks);
+        std::swap (used, other.used);
+        std::swap (base, other.base);
+    }
+
+    /// Allocated bytes
+    std::size_t capacity () const {
+        return chunks.size () * chunk_size;
+    }
+
+private:
+
+    std::deque<std::shared_ptr<char[]>> chunks;
+    std::size_t used = 0;   ///< Bytes in the last chunk
+    std::size_t base = 0;   ///< Chunks released so far
+};
 
 //--------------------------------------------------------------------------------------------------
 
 struct log_index
 {
-    std::uint32_t begin;    ///< Offset within console_t#log_data
-    std::uint32_t out : 1;  ///< True if outgoing, otherwise incoming log message
-    std::uint32_t mid : 7;  ///< Relative position of the actual message i.e. after the prompt
-    std::uint32_t end : 24; ///< Relative one-past-the end. More size, but easier to work with
+    std::uint32_t begin;        ///< Offset of the message within console_t#log_data
+    std::uint32_t out  : 1;     ///< True if outgoing, otherwise incoming log message
+    std::uint32_t size : 31;    ///< Of the message, which follows the prompt
+    std::uint32_t time;         ///< When recorded, in seconds since the Unix epoch
+    std::uint32_t counter;      ///< Of the outgoing or incoming messages, as shown in the prompt
 };
-static_assert (sizeof (log_index) == 8);
+static_assert (sizeof (log_index) == 16);
 
-/// The opposite of what #record_log_message() does wrt to encoding the #log_index
+/// The message only, as the prompt is not stored but made by #format_prompt()
 static inline auto
-extract_message (std::vector<char> const& source, log_index i)
+extract_message (log_text const& source, log_index i)
+{
+    auto b = source.data (i.begin);
+    return std::make_tuple (b, b + i.size);
+}
+
+/// For the "in:" and "out:" query terms
+static inline int
+record_direction (log_index i)
 {
-    return std::make_tuple (&source[i.begin], &source[i.begin + i.mid], &source[i.begin + i.end]);
+    return i.out ? 1 : -1;
 }
 
-/// Adds a prompt and puts into console#log_data and console#log_indexes
-void record_log_message (bool outgoing, std::string const& msg);
+/// Enough for any prompt made by #format_prompt()
+constexpr std::size_t prompt_capacity = 48;
+
+/// The "[YYYY-MM-DD HH:MM:SS]N> " start of a record, as shown and saved, in local time
+std::string_view format_prompt (log_index i, char (&buffer)[prompt_capacity]);
+
+/// Puts the message into console#log_data and console#log_indexes, with the current time
+void record_log_message (bool outgoing, std::string_view msg);
+
+/// Drops the oldest records over console#log_max_records or console#log_max_bytes, though never
+/// the newest one
+void evict_log_records (bool archive = true);
+
+/// The text is released by whole chunks, so a smaller limit would evict all of it each time
+constexpr std::size_t min_log_bytes = 2 * log_text::chunk_size;
+
+/// Offsets of the text are renumbered past a quarter of their range (see log_text#rebase()), so
+/// that the rest of it holds a log of up to that size
+constexpr std::size_t max_log_bytes = std::size_t (2) << 30;
+
+/// Zero, as no limit, or within the range above
+static inline std::size_t
+clamp_log_bytes (std::size_t bytes)
+{
+    return bytes ? std::clamp (bytes, min_log_bytes, max_log_bytes) : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Structured predicates over the log records, written as words among the filter text:
+ * "time:21:10..21:15", "time:2024-03-31T21:10..", "counter:100..200" and so on. A time without a
+ * date is on the day of the latest record. The direction is told by the "in:" and "out:" terms of
+ * the #text_query instead, of which "dir:in" and "dir:out" are left in the text as aliases.
+ */
+
+struct log_query
+{
+    std::uint32_t time_first = 0, time_last = -1;       ///< Inclusive range of log_index#time
+    std::uint32_t counter_first = 0, counter_last = -1; ///< Inclusive range of log_index#counter
+
+    bool operator == (log_query const&) const = default;
+
+    bool any () const {
+        return !(*this == log_query {});
+    }
+
+    /// Takes out the recognized words, returning the rest of the text, wrt to the given time
+    std::string parse (std::string_view text, std::uint32_t now);
+
+    /// Appends the matching records of the range. The time range is found by binary search while
+    /// the records are ordered by time, as recorded, otherwise (e.g. the clock was set back, or a
+    /// loaded line had no time) by checking each of them.
+    void select (log_index const* first, log_index const* last, std::vector<log_index>& dst) const;
+};
 
 //--------------------------------------------------------------------------------------------------
 
@@ -64,14 +266,14 @@ struct help_index
         params_bits  = 6,  params_size  = 1 << params_bits,
         brief_bits   = 7,  brief_size   = 1 << brief_bits,
         details_bits = 11, details_size = 1 << details_bits,
-        waste_bits   = 2,  waste_size   = 1 << waste_bits
+        store_bits   = 2,  store_size   = 1 << store_bits
     };
     std::uint32_t begin  ;     ///< Offset within console_t#help_dat and start of names
     std::uint32_t params : names_bits;
     std::uint32_t brief  : params_bits;
     std::uint32_t details: brief_bits;
     std::uint32_t end    : details_bits;
-    std::uint32_t waste  : waste_bits;
+    std::uint32_t store  : store_bits; ///< Which help it is from, only in the #help_search result
 };
 static_assert (sizeof (help_index) == 8);
 
@@ -87,124 +289,288 @@ extract_message (std::vector<char> const& source, help_index i)
     );
 }
 
-//--------------------------------------------------------------------------------------------------
-
-struct console_t
-{
-    font_t gui_font, log_font;
-    std::uint32_t prompt_color, out_color, in_color;
-
-    std::vector<char> log_data;         ///< Whole, unfiltered buffer, full of terminated records
-    std::vector<log_index> log_indexes; ///< Compressed index for access to #log_data
-    int counter_in, counter_out;
-
-    std::vector<std::string> completers; ///< Used in auto-completion
-
-    std::uint32_t help_names_color, help_params_color, help_brief_color, help_details_color;
-
-    std::vector<char> sse_data, gui_data, alias_data;
-    std::vector<help_index> sse_indexes, gui_indexes, alias_indexes;
-
-    std::vector<std::string> commands;  ///< Queue of commands currently running
-    int execution_delay;                ///< In milliseconds, wrt to #commands
-};
-
-extern console_t console;
-
-bool save_log_file (std::filesystem::path const& filename);
-bool load_log_file (std::filesystem::path const& filename);
-bool load_run_file (std::filesystem::path const& filename);
-bool load_settings ();
-bool save_settings ();
-bool load_help_files ();
-bool save_aliases ();
-
-bool setup ();
-bool setup_render ();
-
-//--------------------------------------------------------------------------------------------------
-
-class skyrim_log {
-public:
-    static void print (const char* format, ...);
-    static std::string last_message ();
-    static void last_message (std::string const&);
-};
-
-class skyrim_console {
-public:
-    static void execute (std::string const& message);
-    static std::uint32_t selected_form ();
-};
-
-void setup_hooks ();
-
-//--------------------------------------------------------------------------------------------------
-
-static inline std::string
-uppercase_string (std::string s)
+/// None, the "in:" and "out:" query terms never match
+static inline int
+record_direction (help_index)
 {
-    for (char& c: s) c = (char) std::toupper (c & 0x7f);
-    return s;
+    return 0;
 }
 
 //--------------------------------------------------------------------------------------------------
 
-/// Cascaded filtering of indexes based on #log_index.
+/**
+ * Cascaded filtering of indexes based on #log_index.
+ *
+ * The results are kept for each #text_query typed, in a chain where each query key is a prefix
+ * of the next one. Typing one more character narrows the smallest cached result of a query
+ * which the new one implies, while deleting one goes back to the result already there. E.g.
+ * "playe" narrows "pla", and "additem -player" narrows "additem", but a longer pattern is always
+ * matched against the whole source, as it may match more. The chain is bounded by #cache_limit
+ * bytes, trimming the least recently used results first.
+ *
+ * The cached results are #ordinal_set of the base records (the scoped or all of the source),
+ * numbered from the first one ever, so that dropping the oldest records does not renumber them.
+ * Only the shown result is made into indexes, as the views need them in order, by position.
+ * Along with the ordinals, the results keep where each record holds the query, as found while
+ * matching, so that the views highlight it without searching again.
+ *
+ * Optionally, results over too many records are made by a #background_worker, out of snapshots of
+ * the text and of the records to match, while the previous result is still shown. A newer needle
+ * cancels it, any other change of the source makes it submitted again by the next #poll(),
+ * otherwise it is taken in by #poll() or #update(), along with the records appended meanwhile.
+ * The snapshot of the base records is reused while the source is only appended, so that the frame
+ * does not copy it on each typed character.
+ */
 
-template<class IndexT>
+template<class IndexT, class TextT = std::vector<char>>
 class records_filter
 {
 public:
 
+    static constexpr std::size_t cache_limit = 64 << 20;
+
+    /// Fewest records of a part when matching in parallel, so a thread is worth waking up
+    static constexpr std::size_t parallel_part = 8192;
+
+    /// Fewest records of a cached result to narrow down further with the #lookup()
+    static constexpr std::size_t lookup_records = 4096;
+
     void init (
-            std::vector<char> const* text,
+            TextT const* text,
             std::vector<IndexT> const* indexes,
-            std::initializer_list<int> segments)
-    {
-        chars.clear ();
-        chars.resize (segments.size ());
-        filters.clear ();
-        filters.resize (segments.size ());
-        splits.clear ();
-        splits.insert (splits.end (), segments.begin (), segments.end ());
+            std::size_t min_needle = 3)
+    {
+        cancel ();
+        levels.clear ();
+        base_frozen = nullptr;
+        min_length = min_needle;
         source_filter = indexes;
         source_text = text;
+        scoping = nullptr;
+        rescope ();
         current_filter = source_filter;
+        shown_id = 0;
+        std::vector<IndexT> ().swap (shown);
+        std::vector<match_span> ().swap (shown_spans);
         buffer.clear ();
         buffer.resize (256, '\0');
+        ++revisions, ++source_revisions;
+    }
+
+    /// Appends these of the source range which can be matched at all
+    typedef std::function<void (IndexT const*, IndexT const*, std::vector<IndexT>&)> scope_type;
+
+    /// Narrows the records the text is matched against, none to match against all of them
+    void scope (scope_type s)
+    {
+        cancel ();
+        scoping = std::move (s);
+        base_frozen = nullptr;
+        rescope ();
+        levels.clear ();
+        show_base ();
+        ++revisions;
+    }
+
+    /// Gives the positions in the source of the records which may match, in order, or false if
+    /// it can't for that text
+    typedef std::function<bool (std::string_view, std::vector<std::uint32_t>&)> lookup_type;
+
+    /// Instead of scanning the whole source, or all of a large cached result, e.g. with an index
+    void lookup (lookup_type l)
+    {
+        looking_up = std::move (l);
+    }
+
+    /// Copy of the source text with the ASCII letters folded, the same offsets, or none
+    void fold (TextT const* folded)
+    {
+        folded_text = folded;
+    }
+
+    /// Results over that many records are made in the background, or none if zero
+    void background (std::size_t min_records)
+    {
+        background_records = min_records;
+    }
+
+    /// Over that many records are matched in parts over all cores, or none if zero
+    void parallel (std::size_t min_records)
+    {
+        parallel_records = min_records;
+    }
+
+    /// The oldest records were removed from the source, which must be ordered by offset
+    void drop (std::size_t count)
+    {
+        ++revisions;
+        interrupt ();
+        dropped_count += count;
+        auto evicted = [this] (std::vector<IndexT>& f)
+        {
+            auto n = f.size ();
+            f.erase (f.begin (), source_filter->empty () ? f.end () : std::lower_bound (
+                        f.begin (), f.end (), source_filter->front ().begin,
+                        [] (IndexT const& a, std::uint32_t b) { return a.begin < b; }));
+            return n - f.size ();
+        };
+        auto removed = evicted (scoped);
+        base_offset += std::uint32_t (scoping ? removed : count);
+        removed = evicted (shown);
+        shown_spans.erase (shown_spans.begin (),
+                shown_spans.begin () + std::min (removed, shown_spans.size ()));
+        for (auto& l: levels)
+        {
+            auto n = l.ordinals.size ();
+            l.ordinals.erase_below (base_offset);
+            l.spans.erase (l.spans.begin (), l.spans.begin () + (n - l.ordinals.size ()));
+        }
+        base_frozen = nullptr;
+        seen -= std::min (seen, count);
+    }
+
+    /// The offsets of all the source records went down by that much, see log_text#rebase()
+    void rebase (std::uint32_t shift)
+    {
+        for (auto& i: scoped)
+            i.begin -= shift;
+        for (auto& i: shown)
+            i.begin -= shift;
+        base_frozen = nullptr;
+        ++revisions;
     }
 
     /// When the indexes/text are reset outside
     void reset ()
     {
-        current_filter = source_filter;
-        std::fill (chars.begin (), chars.end (), "");
-        std::fill (filters.begin (), filters.end (), std::vector<IndexT> ());
+        ++revisions, ++source_revisions;
+        interrupt ();
+        base_frozen = nullptr;
+        rescope ();
+        levels.clear ();
+        show_base ();
     }
 
-    void update (const char* filter_text, bool force_update = false)
+    /// Records appended to the source since the last call are only matched against the levels
+    void update (const char* filter_text)
     {
-        auto text = uppercase_string (trimmed_both (filter_text, ' '));
+        auto matcher = std::make_shared<text_query const> (filter_text);
+        auto text = matcher->key ();
+        if (text != waiting_chars)
+            rerun = false;
 
-        current_filter = source_filter;
-        if (text.size () < splits[0] || source_filter->size () < 2)
+        poll ();
+        if (waiting)
+        {
+            if (text == waiting_chars)
+                return;
+            cancel ();
+        }
+
+        // Likely a pattern still being typed, meanwhile the previous result is shown
+        if (!matcher->error ().empty ())
             return;
 
-        for (std::size_t i = 0, n = filters.size (); i < n; ++i)
+        if (text.size () < min_length || matcher->matches_all ())
         {
-            if (force_update || text.size () >= splits[i])
+            show_base ();
+            return;
+        }
+
+        // The deepest result to insert after, dropping these which can't be reused anymore. If
+        // that was the shown one, it stays until the next one is made.
+        auto base = levels.end ();
+        for (auto l = levels.begin (); l != levels.end (); ++l)
+            if (text.starts_with (l->chars))
+                base = l;
+            else if (!l->chars.starts_with (text))
             {
-                auto text_end = i+1 == n ? text.size () : splits[i];
-
-                if (text.compare (0, text_end, chars[i]))
-                {
-                    chars[i] = text.substr (0, text_end);
-                    filter (filters[i], chars[i].data ());
-                }
-                current_filter = &filters[i];
+                levels.erase (l, levels.end ());
+                break;
             }
+
+        if (base == levels.end () || base->chars != text)
+        {
+            // The smallest result holding all the matches, e.g. of a shorter substring, or of
+            // some of the terms
+            auto from = levels.end ();
+            for (auto l = levels.begin (); l != levels.end (); ++l)
+                if (matcher->implies (*l->matcher) && (from == levels.end ()
+                            || l->ordinals.size () < from->ordinals.size ()))
+                    from = l;
+
+            ordinal_set const* input = from == levels.end () ? nullptr : &from->ordinals;
+            ordinal_set candidates;
+            std::vector<std::uint32_t> positions;
+            if (looking_up && !scoping && (!input || input->size () >= lookup_records)
+                    && looking_up (matcher->literal (), positions))
+            {
+                for (auto p: positions)
+                    candidates.push_back (base_offset + p);
+                if (input)
+                    candidates &= *input;
+                input = &candidates;
+            }
+
+            // Meanwhile, the previous result is shown
+            if (background_records
+                    && (input ? input->size () : base_filter ()->size ()) >= background_records)
+            {
+                ordinals_ptr frozen;
+                if (input == &candidates)
+                    frozen = std::make_shared<ordinal_set const> (std::move (candidates));
+                else if (input)
+                    frozen = std::make_shared<ordinal_set const> (*input);
+                submit (text, std::move (matcher), std::move (frozen));
+                waiting_text = filter_text;
+                return;
+            }
+
+            base = levels.insert (base == levels.end () ? levels.begin () : std::next (base),
+                    level { text, std::move (matcher), {}, {}, 0, ++serials });
+            filter (base->ordinals, base->spans, input, base_offset, *base->matcher);
+        }
+        base->used = ++ticks;
+        show (*base);
+        trim ();
+    }
+
+    /// Matches the appended records and takes in the result made in the background, if any
+    void poll ()
+    {
+        catch_up ();
+
+        // Made anew, after the source changed under the previous one
+        if (rerun)
+        {
+            rerun = false;
+            update (waiting_text.c_str ());
+            return;
         }
+
+        std::unique_ptr<job> done (jobs->finished.exchange (nullptr));
+        if (!done || !waiting || done->generation != jobs->generation)
+            return;
+        waiting = false;
+
+        // The job saw the base records of its snapshot only
+        filter (done->result, done->spans, nullptr,
+                done->offset + std::uint32_t (done->base_size), *done->matcher);
+
+        auto base = levels.end ();
+        for (auto l = levels.begin (); l != levels.end (); ++l)
+            if (done->chars.starts_with (l->chars))
+                base = l;
+        base = levels.insert (base == levels.end () ? levels.begin () : std::next (base), level {
+                std::move (done->chars), std::move (done->matcher), std::move (done->result),
+                std::move (done->spans), ++ticks, ++serials });
+        show (*base);
+        trim ();
+    }
+
+    /// A result is being made in the background, while the previous one is shown
+    bool pending () const {
+        return waiting;
     }
 
     std::vector<char> buffer;   ///< Moved in here the GUI input text field storage
@@ -213,36 +579,848 @@ public:
         return current_filter;
     }
 
-    std::vector<char> const* source_data () const {
+    /// Where the current record at that position holds the query, none if not filtered
+    match_span highlight (std::size_t i) const {
+        return current_filter == &shown && i < shown_spans.size () ? shown_spans[i] : match_span {};
+    }
+
+    TextT const* source_data () const {
         return source_text;
     }
 
+    std::vector<IndexT> const* source_indexes () const {
+        return source_filter;
+    }
+
+    /// Changes when the current indexes change other than by appending, e.g. new filter text,
+    /// so the views know to redo their layout
+    std::size_t revision () const {
+        return revisions;
+    }
+
+    /// Changes on #reset() only, i.e. when the source was replaced or edited in the middle
+    std::size_t source_revision () const {
+        return source_revisions;
+    }
+
+    /// How many source records were removed from the front by #drop(), ever
+    std::size_t dropped () const {
+        return dropped_count;
+    }
+
+    /// Bytes held by the cached results
+    std::size_t memory () const
+    {
+        auto n = (scoped.capacity () + shown.capacity () + (base_frozen ? base_frozen->size () : 0))
+            * sizeof (IndexT) + shown_spans.capacity () * sizeof (match_span);
+        for (auto const& l: levels)
+            n += l.ordinals.memory () + l.spans.capacity () * sizeof (match_span);
+        return n;
+    }
+
 private:
 
+    typedef std::shared_ptr<std::vector<IndexT> const> snapshot;
+
+    typedef std::shared_ptr<ordinal_set const> ordinals_ptr;
+
+    typedef std::shared_ptr<text_query const> matcher_ptr;
+
+    struct level
+    {
+        std::string chars;              ///< Query key, of which the previous level is a prefix
+        matcher_ptr matcher;            ///< Compiled out of the query
+        ordinal_set ordinals;           ///< Of the matching base records
+        std::vector<match_span> spans;  ///< Of each of the ordinals, in order
+        std::size_t used;               ///< When last shown, for trimming
+        std::size_t id;                 ///< Unique, to know if it is the one shown
+    };
+
+    /// Owned by the worker while running, then by #jobs once finished
+    struct job
+    {
+        std::string chars;
+        matcher_ptr matcher;
+        TextT text;                     ///< Snapshot of the source or of the folded text
+        bool folded;
+        snapshot base;                  ///< Of the base records
+        std::size_t base_size;
+        std::uint32_t offset;           ///< Ordinal of the first base record
+        ordinals_ptr input;             ///< To match, or all of the base records if none
+        ordinal_set result;
+        std::vector<match_span> spans;
+        std::size_t min_parallel;
+        std::size_t generation;         ///< Stale if not the same as in #jobs
+    };
+
+    /// Shared with the worker, which may outlive this filter
+    struct channel
+    {
+        std::atomic<std::size_t> generation = 0;
+        std::atomic<job*> finished = nullptr;
+        ~channel () {
+            delete finished.load ();
+        }
+    };
+
+    std::size_t revisions = 0, source_revisions = 0;
+    std::size_t dropped_count = 0;
+
     std::vector<IndexT> const* current_filter;
-    std::vector<char> const* source_text;
+    TextT const* source_text;
     std::vector<IndexT> const* source_filter;
-    std::vector<std::string> chars;
-    std::vector<std::vector<IndexT>> filters;
-    std::vector<std::size_t> splits;
+    std::list<level> levels;
+    std::vector<IndexT> shown;      ///< Made out of a level, kept until the next one is made
+    std::vector<match_span> shown_spans;
+    std::size_t shown_id = 0;       ///< Of that level, if still there
+    std::size_t min_length = 3;
+    std::size_t ticks = 0, serials = 0;
+
+    TextT const* folded_text = nullptr;
+    lookup_type looking_up;
+    scope_type scoping;
+    std::vector<IndexT> scoped;
+    std::uint32_t base_offset = 0;  ///< Ordinal of the first base record
+
+    std::size_t seen = 0;   ///< Source records the levels are up to date with
+
+    std::size_t parallel_records = 0;
+    std::size_t background_records = 0;
+    snapshot base_frozen;           ///< Of the base records, for the background jobs
+    std::shared_ptr<channel> jobs = std::make_shared<channel> ();
+    bool waiting = false;
+    std::string waiting_chars;
+    std::string waiting_text;       ///< As given to #update(), to submit again if interrupted
+    bool rerun = false;
+    background_worker worker;
+
+    void rescope ()
+    {
+        scoped.clear ();
+        if (scoping)
+            scoping (source_filter->data (), source_filter->data () + source_filter->size (),
+                    scoped);
+        base_offset = 0;
+        seen = source_filter->size ();
+    }
+
+    std::vector<IndexT> const* base_filter () const {
+        return scoping ? &scoped : source_filter;
+    }
+
+    void show_base ()
+    {
+        if (current_filter == base_filter ())
+            return;
+        current_filter = base_filter ();
+        shown_id = 0;
+        std::vector<IndexT> ().swap (shown);
+        std::vector<match_span> ().swap (shown_spans);
+        ++revisions;
+    }
+
+    void show (level const& l)
+    {
+        if (current_filter == &shown && shown_id == l.id)
+            return;
+        auto const& base = *base_filter ();
+        shown.clear ();
+        shown.reserve (l.ordinals.size ());
+        for (auto o: l.ordinals)
+            shown.push_back (base[o - base_offset]);
+        shown_spans = l.spans;
+        current_filter = &shown;
+        shown_id = l.id;
+        ++revisions;
+    }
+
+    /// The new records which match a level are all what the next level has to check, if the
+    /// query of the latter implies the former one
+    void catch_up ()
+    {
+        auto n = source_filter->size ();
+        if (seen > n) // Shrunk without notice, nothing to rely on
+        {
+            interrupt ();
+            base_frozen = nullptr;
+            rescope ();
+            levels.clear ();
+            show_base ();
+            return;
+        }
+        if (seen == n)
+            return;
+
+        auto const& base = *base_filter ();
+        auto first = base_offset + std::uint32_t (scoping ? scoped.size () : seen);
+        if (scoping)
+            scoping (source_filter->data () + seen, source_filter->data () + n, scoped);
+        seen = n;
+
+        level const* previous = nullptr;
+        for (auto& l: levels)
+        {
+            auto n = l.spans.size ();
+            filter (l.ordinals, l.spans, previous && l.matcher->implies (*previous->matcher)
+                    ? &previous->ordinals : nullptr, first, *l.matcher);
+            if (l.id == shown_id && current_filter == &shown)
+            {
+                for (auto i = l.ordinals.lower_bound (first); i != l.ordinals.end (); ++i)
+                    shown.push_back (base[*i - base_offset]);
+                shown_spans.insert (shown_spans.end (), l.spans.begin () + n, l.spans.end ());
+            }
+            previous = &l;
+        }
+    }
 
-    // Go through the real source of text and find matches
-    void filter (std::vector<IndexT>& dst, const char* txt)
+    /// Least recently used results go first, though never the current one
+    void trim ()
     {
-        dst.clear ();
-        auto s = uppercase_string (txt);
-        std::copy_if (current_filter->cbegin (), current_filter->cend (), std::back_inserter (dst),
-                [&s, this] (IndexT const& n)
+        while (levels.size () > 1 && memory () > cache_limit)
         {
-            auto t = extract_message (*source_text, n);
+            auto oldest = levels.end ();
+            for (auto l = levels.begin (); l != levels.end (); ++l)
+                if (l->id != shown_id && (oldest == levels.end () || l->used < oldest->used))
+                    oldest = l;
+            if (oldest == levels.end ())
+                break;
+            levels.erase (oldest);
+        }
+    }
+
+    /// Whatever runs in the background is not wanted anymore
+    void cancel ()
+    {
+        if (waiting)
+            ++jobs->generation;
+        waiting = false;
+        rerun = false;
+    }
+
+    /// Whatever runs in the background can't be taken in anymore, but the query is still wanted
+    void interrupt ()
+    {
+        bool was_waiting = waiting;
+        cancel ();
+        rerun = was_waiting;
+    }
+
+    /// Copied once, then reused until too many records were appended to the base since
+    snapshot freeze ()
+    {
+        auto const& base = *base_filter ();
+        if (!base_frozen || base.size () - base_frozen->size () > background_records / 16)
+            base_frozen = std::make_shared<std::vector<IndexT> const> (base);
+        return base_frozen;
+    }
+
+    /// The base records appended after the snapshot are matched when the result is taken in
+    void submit (std::string const& text, matcher_ptr matcher, ordinals_ptr input)
+    {
+        auto j = std::make_shared<job> ();
+        j->chars = text;
+        j->matcher = std::move (matcher);
+        j->text = folded_text ? *folded_text : *source_text;
+        j->folded = folded_text != nullptr;
+        j->base = freeze ();
+        j->base_size = j->base->size ();
+        j->offset = base_offset;
+        j->input = std::move (input);
+        j->min_parallel = parallel_records;
+        j->generation = ++jobs->generation;
+        waiting = true;
+        waiting_chars = text;
+
+        worker.submit ([j, c = jobs]
+        {
+            if (!scan (j->result, j->spans, j->input.get (), j->offset, *j->base, j->offset,
+                        j->text, j->folded, *j->matcher, j->min_parallel,
+                        [&j, &c] { return c->generation != j->generation; }))
+                return;
+            j->input = nullptr;
+            j->base = nullptr;
+            delete c->finished.exchange (new job (std::move (*j)));
+        });
+    }
+
+    /**
+     * Appends the ordinals of the base records which hold the text, and where they do, out of
+     * these in the input set or out of all base records, from the given ordinal on. In blocks,
+     * so that the worker can give up soon after a newer job was submitted, and so that each block
+     * can be matched in parts. False if given up.
+     */
+    template<class Cancelled>
+    static bool scan (ordinal_set& dst, std::vector<match_span>& spans, ordinal_set const* input,
+            std::uint32_t first, std::vector<IndexT> const& base, std::uint32_t offset,
+            TextT const& text, bool folded, text_query const& query, std::size_t min_parallel,
+            Cancelled&& cancelled)
+    {
+        auto last = offset + std::uint32_t (base.size ());
+        auto block = std::max<std::size_t> (4096, min_parallel);
+        auto i = input ? input->lower_bound (first) : ordinal_set::const_iterator {};
+        std::vector<std::uint32_t> ordinals;
+        while (true)
+        {
+            if (cancelled ())
+                return false;
+            ordinals.clear ();
+            if (input)
+                for (; i != input->end () && *i < last && ordinals.size () < block; ++i)
+                    ordinals.push_back (*i);
+            else
+                for (; first < last && ordinals.size () < block; ++first)
+                    ordinals.push_back (first);
+            if (ordinals.empty ())
+                return true;
+            match (dst, spans, ordinals.data (), ordinals.data () + ordinals.size (),
+                    base.data (), offset, text, folded, query, min_parallel);
+        }
+    }
+
+    /// Appends the ordinals of the records which hold the text, in parts over all cores if
+    /// there are at least that many records, concatenating the matches of the parts in order
+    static void match (ordinal_set& dst, std::vector<match_span>& spans,
+            std::uint32_t const* first, std::uint32_t const* last, IndexT const* base,
+            std::uint32_t offset, TextT const& text, bool folded, text_query const& query,
+            std::size_t min_parallel)
+    {
+        auto holds = [&] (std::uint32_t o, match_span& span)
+        {
+            auto const& n = base[o - offset];
+            auto t = extract_message (text, n);
             auto b = std::get<0> (t);
             auto e = std::get<std::tuple_size<decltype(t)>::value - 1> (t);
-            auto u = uppercase_string (std::string (b, e));
-            return u.find (s) != std::string::npos;
+            auto d = record_direction (n);
+            return folded ? query.contains_folded (b, e, d, span) : query.contains (b, e, d, span);
+        };
+
+        std::size_t n = last - first;
+        std::size_t parts = min_parallel && n >= min_parallel
+            ? std::min (parallel_threads (), n / parallel_part) : 1;
+        match_span span;
+        if (parts < 2)
+        {
+            for (; first != last; ++first)
+                if (holds (*first, span))
+                    dst.push_back (*first), spans.push_back (span);
+            return;
+        }
+
+        std::vector<std::vector<std::uint32_t>> found (parts);
+        std::vector<std::vector<match_span>> found_spans (parts);
+        run_parallel (parts, [&] (std::size_t i)
+        {
+            match_span span;
+            for (auto o = first + n * i / parts, e = first + n * (i+1) / parts; o != e; ++o)
+                if (holds (*o, span))
+                    found[i].push_back (*o), found_spans[i].push_back (span);
         });
+        for (std::size_t i = 0; i < parts; ++i)
+        {
+            for (auto o: found[i])
+                dst.push_back (o);
+            spans.insert (spans.end (), found_spans[i].begin (), found_spans[i].end ());
+        }
+    }
+
+    void filter (ordinal_set& dst, std::vector<match_span>& spans, ordinal_set const* input,
+            std::uint32_t first, text_query const& matcher)
+    {
+        scan (dst, spans, input, first, *base_filter (), base_offset,
+                folded_text ? *folded_text : *source_text, folded_text != nullptr, matcher,
+                parallel_records, [] { return false; });
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Stepping through the records which hold a #text_query, among all of the source records, e.g.
+ * to jump between them while the whole log is shown.
+ *
+ * The matches are found lazily, scanning the source in chunks of #chunk_records outwards of the
+ * range already scanned, only as far as it takes to reach the next match in the asked direction.
+ * They are kept as a sorted array of ordinals, numbered from the first record ever, so stepping
+ * among the already found ones is a binary search, appending to the source only widens the range
+ * to scan, and dropping the oldest records drops only their matches.
+ */
+
+template<class IndexT, class TextT = std::vector<char>>
+class records_finder
+{
+public:
+
+    /// Matched at once, about a tenth of a millisecond of scanning
+    static constexpr std::size_t chunk_records = 16384;
+
+    static constexpr std::size_t npos = std::size_t (-1);
+
+    void init (TextT const* text, std::vector<IndexT> const* indexes)
+    {
+        source_text = text;
+        source_filter = indexes;
+        query = nullptr;
+        reset ();
+    }
+
+    /// Copy of the source text with the ASCII letters folded, the same offsets, or none
+    void fold (TextT const* folded)
+    {
+        folded_text = folded;
+    }
+
+    /// Starts over, unless the query means the same as the current one, false if unusable
+    bool find (std::string_view text)
+    {
+        auto q = std::make_shared<text_query const> (text);
+        if (!q->error ().empty () || q->matches_all ())
+        {
+            query = nullptr;
+            reset ();
+            return false;
+        }
+        if (!query || query->key () != q->key ())
+        {
+            query = std::move (q);
+            reset ();
+        }
+        return true;
+    }
+
+    /// Goes to the first match after the found one, or from the first record if none, wrapping
+    /// around at the end, false if there is no match at all
+    bool next ()
+    {
+        auto start = found_ordinal == npos ? dropped_count : found_ordinal + 1;
+        auto o = forward (start);
+        if (o == npos && start != dropped_count)
+            o = forward (dropped_count);
+        return go (o);
+    }
+
+    /// Goes to the last match before the found one, or from the last record if none, wrapping
+    /// around at the start, false if there is no match at all
+    bool previous ()
+    {
+        auto end = dropped_count + source_filter->size ();
+        auto o = backward (found_ordinal == npos ? end : found_ordinal);
+        if (o == npos && found_ordinal != npos)
+            o = backward (end);
+        return go (o);
+    }
+
+    /// Position in the source of the last record gone to, or #npos if none
+    std::size_t found () const {
+        return found_ordinal == npos || found_ordinal < dropped_count
+            || found_ordinal - dropped_count >= source_filter->size ()
+            ? npos : found_ordinal - dropped_count;
+    }
+
+    /// Where the found record holds the query
+    match_span found_span () const {
+        return span;
+    }
+
+    /// The oldest records were removed from the source
+    void drop (std::size_t count)
+    {
+        dropped_count += count;
+        hits.erase (hits.begin (), std::lower_bound (hits.begin (), hits.end (), dropped_count));
+        scanned_first = std::max (scanned_first, dropped_count);
+        scanned_last = std::max (scanned_last, dropped_count);
+    }
+
+    /// When the indexes/text are reset outside
+    void reset ()
+    {
+        hits.clear ();
+        hits.shrink_to_fit ();
+        dropped_count = scanned_first = scanned_last = 0;
+        found_ordinal = npos;
+        span = {};
+    }
+
+    /// Bytes held by the found matches
+    std::size_t memory () const {
+        return hits.capacity () * sizeof (std::size_t);
+    }
+
+private:
+
+    TextT const* source_text;
+    TextT const* folded_text = nullptr;
+    std::vector<IndexT> const* source_filter;
+    std::shared_ptr<text_query const> query;
+
+    std::vector<std::size_t> hits;      ///< Ordinals of the matches in the scanned range
+    std::size_t scanned_first = 0;      ///< The scanned range of ordinals, without gaps
+    std::size_t scanned_last = 0;
+    std::size_t dropped_count = 0;      ///< Ordinal of the first source record
+    std::size_t found_ordinal = npos;
+    match_span span;
+
+    bool go (std::size_t o)
+    {
+        if (o == npos)
+            return false;
+        found_ordinal = o;
+        holds (source_filter->at (o - dropped_count), span);
+        return true;
+    }
+
+    bool holds (IndexT const& n, match_span& where) const
+    {
+        auto t = extract_message (folded_text ? *folded_text : *source_text, n);
+        auto b = std::get<0> (t);
+        auto e = std::get<std::tuple_size<decltype(t)>::value - 1> (t);
+        auto d = record_direction (n);
+        return folded_text ? query->contains_folded (b, e, d, where)
+                           : query->contains (b, e, d, where);
+    }
+
+    /// Starts the scanned range anew if the ordinal is not within it or next to it, so that it
+    /// stays without gaps, or if the source shrunk without notice
+    void rescan_from (std::size_t o)
+    {
+        if (o < scanned_first || o > scanned_last
+                || scanned_last > dropped_count + source_filter->size ())
+        {
+            hits.clear ();
+            scanned_first = scanned_last = o;
+        }
+    }
+
+    /// Ordinal of the first match from the given one on, or #npos
+    std::size_t forward (std::size_t o)
+    {
+        if (!query)
+            return npos;
+        auto end = dropped_count + source_filter->size ();
+        o = std::clamp (o, dropped_count, end);
+        rescan_from (o);
+        while (true)
+        {
+            auto h = std::lower_bound (hits.begin (), hits.end (), o);
+            if (h != hits.end ())
+                return *h;
+            if (scanned_last >= end)
+                return npos;
+            match_span unused;
+            for (auto last = std::min (end, scanned_last + chunk_records); scanned_last < last;
+                    ++scanned_last)
+                if (holds ((*source_filter)[scanned_last - dropped_count], unused))
+                    hits.push_back (scanned_last);
+        }
+    }
+
+    /// Ordinal of the last match before the given one, or #npos
+    std::size_t backward (std::size_t o)
+    {
+        if (!query)
+            return npos;
+        o = std::clamp (o, dropped_count, dropped_count + source_filter->size ());
+        rescan_from (o);
+        while (true)
+        {
+            auto h = std::lower_bound (hits.begin (), hits.end (), o);
+            if (h != hits.begin ())
+                return *std::prev (h);
+            if (scanned_first <= dropped_count)
+                return npos;
+            std::vector<std::size_t> chunk;
+            match_span unused;
+            auto first = scanned_first - std::min (scanned_first - dropped_count, chunk_records);
+            for (auto i = first; i < scanned_first; ++i)
+                if (holds ((*source_filter)[i - dropped_count], unused))
+                    chunk.push_back (i);
+            hits.insert (hits.begin (), chunk.begin (), chunk.end ());
+            scanned_first = first;
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * One search over all of the help: the Skyrim, the GUI and the alias commands, ranked by where
+ * the #text_query holds. First go the records having a name which starts with its longest
+ * literal, the shorter names first, then the rest by where the query was found (see #match_span):
+ * in the names, then in the brief text, and last in the details. A query of a single word is
+ * likely a mistyped name, so after all these go the records with the closest fuzzy matching
+ * names (see #fuzzy_pattern), by their score.
+ *
+ * The folded names are kept in a sorted index, so the first rank is a binary search. It is remade
+ * on any change of the help, but an added or deleted alias is only put in or taken out. The rest
+ * are matched once each, but only among the matches of the previous query, while the new one
+ * implies it, e.g. as typed. The result is like a new source to the views each time, as it is
+ * not in the order of any help.
+ */
+
+class help_search
+{
+public:
+
+    std::vector<char> buffer;   ///< Moved in here the GUI input text field storage
+
+    /// Clears the query and remakes the index
+    void init ();
+
+    /// Remakes the index and the result, after the help changed
+    void reset ();
+
+    /// Indexes the alias appended last, and redoes the result
+    void alias_added ();
+
+    /// Takes out of the index the alias which was at that position, and redoes the result
+    void alias_erased (std::uint32_t position);
+
+    /// Ranks the help records holding the text, all of them if it matches all, then the fuzzy ones
+    void update (const char* text);
+
+    std::vector<help_index> const* current_indexes () const {
+        return &results;
+    }
+
+    std::vector<help_index> const* source_indexes () const {
+        return &results;
+    }
+
+    /// Of the help the record is from, see help_index#store
+    std::vector<char> const& source_data (help_index i) const;
+
+    /// Where the record at that position holds the query, if it does
+    match_span highlight (std::size_t i) const {
+        return i < spans.size () ? spans[i] : match_span {};
+    }
+
+    std::size_t revision () const {
+        return revisions;
+    }
+
+    /// Any new result is a new source
+    std::size_t source_revision () const {
+        return revisions;
+    }
+
+    std::size_t dropped () const {
+        return 0;
+    }
+
+    /// Bytes held by the index and the result
+    std::size_t memory () const;
+
+private:
+
+    /// A name of a help record, as a key being its store and its position there
+    struct name_entry
+    {
+        std::uint32_t offset;           ///< Within #names
+        std::uint32_t length;
+        std::uint32_t key;
+        std::uint32_t within;           ///< Offset of the name in its record
+        std::uint64_t mask;             ///< Of its characters, see fuzzy_mask()
+    };
+
+    std::string names;                  ///< Folded, one after another
+    std::vector<name_entry> index;      ///< Sorted by the names
+    std::vector<help_index> results;
+    std::vector<match_span> spans;      ///< Of each of the #results
+    std::vector<std::uint32_t> matched; ///< Keys of the #results, in the order of the help
+    std::shared_ptr<text_query const> matcher;
+    std::size_t revisions = 0;
+
+    /// Appends the names of the record to #names and their (unsorted) entries
+    void index_names (std::uint32_t store, std::uint32_t position, std::vector<name_entry>& dst);
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * The names to complete, as written one after another in a single pool of text, and folded (see
+ * fold_ascii()) in another one. The index of them is sorted by the folded names, so the names
+ * starting with a prefix, in any letter case, are a range of it found by a binary search. The
+ * sorted positions are valid until the next change, as told by the #revision().
+ */
+
+class completion_names
+{
+public:
+
+    /// Replaces all of them, skipping the duplicates
+    void assign (std::vector<std::string> const& names);
+
+    /// @returns false if already in
+    bool insert (std::string_view name);
+
+    /// @returns false if not in
+    bool erase (std::string_view name);
+
+    bool contains (std::string_view name) const;
+
+    std::size_t size () const {
+        return index.size ();
+    }
+
+    /// The terminated name at that sorted position
+    const char* operator [] (std::size_t i) const {
+        return &text[index[i].offset];
+    }
+
+    std::string_view name (std::size_t i) const {
+        return std::string_view (&text[index[i].offset], index[i].length);
+    }
+
+    /// Of the characters of the name, see fuzzy_mask()
+    std::uint64_t mask (std::size_t i) const {
+        return index[i].mask;
+    }
+
+    /// The sorted positions of the names starting with that, in any letter case
+    std::pair<std::size_t, std::size_t> prefixed (std::string_view prefix) const;
+
+    std::size_t revision () const {
+        return revisions;
+    }
+
+    std::size_t memory () const {
+        return text.capacity () + folded.capacity () + index.capacity () * sizeof (entry);
+    }
+
+private:
+
+    struct entry
+    {
+        std::uint32_t offset;           ///< In both #text and #folded
+        std::uint32_t length;
+        std::uint64_t mask;
     };
+
+    std::string text;                   ///< Each name terminated
+    std::string folded;
+    std::vector<entry> index;
+    std::size_t revisions = 0;
+
+    /// Positions of the names which fold to the same as that one
+    std::pair<std::size_t, std::size_t> folded_range (std::string_view name) const;
+
+    /// The pools in the order of the index, without the erased names
+    void compact ();
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// Cycles through the console#completers starting with the word under the cursor, or if none
+/// does, through the closest fuzzy matching ones, as with a mistyped name
+
+class text_completion
+{
+public:
+
+    /**
+     * @param text is the whole input line
+     * @param cursor is the position within the @p text
+     * @param start is set to the offset of the text to be replaced
+     * @param count is set to the length of the text to be replaced
+     * @returns the replacement (to be followed by a space) or nullptr if none
+     */
+    const char* complete (std::string_view text, int cursor, int& start, int& count);
+
+    /// Remember the resulting text, so a repeated #complete() on it cycles to the next match
+    void completed (std::string_view text);
+
+private:
+
+    std::vector<std::uint32_t> fuzzy;   ///< Positions in console#completers, if none is prefixed
+    std::size_t first = 0, last = 0;    ///< Range of the matches, their positions or in #fuzzy
+    std::size_t current = 0;
+    std::size_t names_revision = 0;     ///< Of console#completers, when the range was found
+    std::hash<std::string_view> hash;
+    std::size_t prev_uid = hash (std::string_view ("", 0));
+    int prev_start = 0, prev_len = 0;
+
+    const char* match (std::size_t i) const;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+struct console_t
+{
+    log_text log_data;                  ///< Whole, unfiltered buffer, full of terminated records
+    std::vector<log_index> log_indexes; ///< Compressed index for access to #log_data
+    int counter_in, counter_out;
+    int current_history;                ///< Position in #log_indexes for the input history
+
+    completion_names completers;        ///< Used in auto-completion
+
+    std::vector<char> sse_data, gui_data, alias_data;
+    std::vector<help_index> sse_indexes, gui_indexes, alias_indexes;
+
+    bool fold_copies;                   ///< Keep the copies below, so the filters do less work
+    log_text log_folded;
+    std::vector<char> sse_folded, gui_folded, alias_folded;
+
+    bool index_log;                     ///< Keep the #log_trigrams, for the very large logs
+    trigram_index log_trigrams;
+
+    records_filter<log_index, log_text> log_filter;
+    log_query log_scope;                ///< What of #log_filter text was not for matching
+    records_filter<help_index> sse_filter, gui_filter, alias_filter;
+    help_search all_help;               ///< Over all of the above help, ranked
+
+    bool log_find;                      ///< The #log_filter text finds, instead of filtering
+    records_finder<log_index, log_text> log_finder;
+
+    std::vector<std::string> commands;  ///< Queue of commands currently running
+    int execution_delay;                ///< In milliseconds, wrt to #commands
+
+    std::size_t log_max_records;        ///< Oldest records over it are evicted, zero if no limit
+    std::size_t log_max_bytes;          ///< Same, wrt to the #log_data allocated memory
+    bool log_archive;                   ///< Append the evicted records to the archive log file
+
+    bool scroll_to_bottom;              ///< Request to the GUI to show the latest record
+    bool scroll_to_found;               ///< Request to the GUI to show the log_finder one
+    bool log_to_clipboard;              ///< Request to the GUI to copy the displayed records
 };
 
+extern console_t console;
+
+bool save_log_file (std::filesystem::path const& filename);
+bool load_log_file (std::filesystem::path const& filename);
+bool archive_log_records (std::size_t count);
+bool load_run_file (std::filesystem::path const& filename);
+bool load_help_files ();
+bool save_aliases ();
+
+/// Resets the state, except the loaded data, and links the filters to it
+void setup_console ();
+
+/// Runs a GUI (/...), alias (.name) or a Skyrim command and records the outcome in the log
+void execute_command (std::string cmd);
+
+/// Pops and runs the next command of the script, if any, otherwise stops the timer
+void execute_queued_command ();
+
+/// Makes, or drops, the log copy wrt to console#fold_copies, after it was changed as a whole
+void fold_log_copy ();
+
+/// Same for the help and aliases copies, which are small enough to redo on any change, and for
+/// the console#all_help index
+void fold_help_copies ();
+
+/// Makes, or drops, the log index wrt to console#index_log, after the log was changed as a whole
+void index_log_trigrams ();
+
+/// Breakdown of the memory held by the console data, for the "/memory" command
+std::string memory_usage ();
+
+/// Applies the console#log_filter buffer, with any #log_query words in it, or with
+/// console#log_find, looks it up in the whole log instead
+void update_log_filter ();
+
+/// Goes to the next, or the previous, record of the whole log holding the console#log_finder
+/// query, and asks the GUI to show it
+void find_log_record (bool backward);
+
 //--------------------------------------------------------------------------------------------------
 
 #endif //SSE_CONSOLE_HPP
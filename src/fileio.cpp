@@ -26,15 +26,14 @@
  */
 
 #include "console.hpp"
-#include <utils/winutils.hpp>
 #include <charconv>
 
 static const struct {
     std::filesystem::path
-        settings = plugin_directory () + "settings.json",
         help_sse = plugin_directory () + "help_sse.json",
         help_gui = plugin_directory () + "help_gui.json",
-        help_alias = plugin_directory () + "help_alias.json";
+        help_alias = plugin_directory () + "help_alias.json",
+        archive = plugin_directory () + "archive.log";
 }
 locations;
 
@@ -52,10 +51,11 @@ save_log_file (std::filesystem::path const& filename)
             return false;
         }
 
+        char prompt[prompt_capacity];
         for (auto const& i: console.log_indexes)
         {
-            auto [b, m, e] = extract_message (console.log_data, i);
-            fo << std::string_view (b, std::size_t (e-b)) << std::endl;
+            auto [b, e] = extract_message (console.log_data, i);
+            fo << format_prompt (i, prompt) << std::string_view (b, std::size_t (e-b)) << '\n';
         }
     }
     catch (std::exception const& ex)
@@ -68,6 +68,69 @@ save_log_file (std::filesystem::path const& filename)
 
 //--------------------------------------------------------------------------------------------------
 
+/// Appends the oldest records in the same format as #save_log_file() does
+bool
+archive_log_records (std::size_t count)
+{
+    try
+    {
+        std::ofstream fo (locations.archive, std::ios::app);
+        if (!fo.is_open ())
+        {
+            log () << "Unable to open " << locations.archive << " for writting." << std::endl;
+            return false;
+        }
+
+        char prompt[prompt_capacity];
+        count = std::min (count, console.log_indexes.size ());
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto ndx = console.log_indexes[i];
+            auto [b, e] = extract_message (console.log_data, ndx);
+            fo << format_prompt (ndx, prompt) << std::string_view (b, std::size_t (e-b)) << '\n';
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        log () << __func__ << ":" << ex.what () << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reverse of the "[YYYY-MM-DD HH:MM:SS]" local time in the prompt, as converted by each line on
+ * its own. The loading is bound by the reading anyway, and nothing is kept between the calls.
+ */
+
+static std::uint32_t
+parse_prompt_time (std::string_view s)
+{
+    auto number = [&s] (std::size_t pos, std::size_t len)
+    {
+        int v = 0;
+        std::from_chars (s.data () + pos, s.data () + pos + len, v);
+        return v;
+    };
+
+    if (s.size () < 21 || s[0] != '[' || s[20] != ']')
+        return 0;
+
+    std::tm tm {};
+    tm.tm_year = number (1, 4) - 1900;
+    tm.tm_mon = number (6, 2) - 1;
+    tm.tm_mday = number (9, 2);
+    tm.tm_hour = number (12, 2);
+    tm.tm_min = number (15, 2);
+    tm.tm_sec = number (18, 2);
+    tm.tm_isdst = -1;
+    return std::uint32_t (std::max<std::time_t> (0, std::mktime (&tm)));
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool
 load_log_file (std::filesystem::path const& filename)
 {
@@ -80,10 +143,9 @@ load_log_file (std::filesystem::path const& filename)
             return false;
         }
 
-        std::vector<char> log_data;
+        log_text log_data;
         std::vector<log_index> log_indexes;
         int counter_out = 0, counter_in = 0;
-        int last_cnt[4] = {-1,-1,-1,-1};
 
         for (std::string row; std::getline (fi, row); )
         {
@@ -93,36 +155,29 @@ load_log_file (std::filesystem::path const& filename)
             if (mid == std::string::npos)
                 continue;
 
+            std::string_view prompt (row.data (), mid), message (row);
+            message.remove_prefix (std::min (mid + 2, row.size ()));
+
             log_index i;
-            i.begin = log_data.size ();
-            i.mid = std::min (mid + 2, row.size ());
-            i.end = row.size ();
+            i.begin = log_data.append (message);
+            i.size = std::uint32_t (std::min (message.size (), log_text::chunk_size));
             i.out = row[mid] == '>';
+            i.time = parse_prompt_time (prompt);
+            i.counter = 0;
+            if (auto c = prompt.find (']'); c != std::string_view::npos)
+                std::from_chars (prompt.data () + c + 1, prompt.data () + mid, i.counter);
 
             log_indexes.push_back (i);
-            log_data.insert (log_data.end (), row.begin (), row.end ());
-
-            if (i.out) last_cnt[0] = int (i.begin), last_cnt[1] = int (i.mid);
-            else       last_cnt[2] = int (i.begin), last_cnt[3] = int (i.mid);
-        }
-
-        if (last_cnt[0] > 0)
-        {
-            std::string_view in (&log_data[last_cnt[0]], last_cnt[1]);
-            in.remove_prefix (in.find (']') + 1);
-            std::from_chars (in.data (), in.data () + in.size (), counter_out);
-        }
-        if (last_cnt[2] > 0)
-        {
-            std::string_view in (&log_data[last_cnt[2]], last_cnt[1]);
-            in.remove_prefix (in.find (']') + 1);
-            std::from_chars (in.data (), in.data () + in.size (), counter_in);
+            (i.out ? counter_out : counter_in) = int (i.counter);
         }
 
         console.log_indexes.swap (log_indexes);
         console.log_data.swap (log_data);
         console.counter_in = counter_in;
         console.counter_out = counter_out;
+        evict_log_records (false);
+        fold_log_copy ();
+        index_log_trigrams ();
     }
     catch (std::exception const& ex)
     {
@@ -176,106 +231,6 @@ load_run_file (std::filesystem::path const& filename)
 
 //--------------------------------------------------------------------------------------------------
 
-bool
-save_settings ()
-{
-    try
-    {
-        nlohmann::json json = {
-            { "Log colors", {
-                { "prompt", hex_string (console.prompt_color) },
-                { "out", hex_string (console.out_color) },
-                { "in", hex_string (console.in_color) },
-            }},
-            { "Help colors", {
-                { "names", hex_string (console.help_names_color) },
-                { "params", hex_string (console.help_params_color) },
-                { "brief", hex_string (console.help_brief_color) },
-                { "details", hex_string (console.help_details_color) },
-            }},
-            { "Execution delay", console.execution_delay }
-        };
-
-        save_font (json, console.gui_font);
-        save_font (json, console.log_font);
-        save_json (json, locations.settings);
-    }
-    catch (std::exception const& ex)
-    {
-        log () << "Unable to save settings file: " << ex.what () << std::endl;
-        return false;
-    }
-    return true;
-}
-
-//--------------------------------------------------------------------------------------------------
-
-bool
-load_settings ()
-{
-    try
-    {
-        auto json = load_json (locations.settings);
-
-        console.gui_font.name = "Default";
-        console.gui_font.scale = 1.f;
-        console.gui_font.size = 32.f;
-        console.gui_font.color = IM_COL32_WHITE;
-        console.gui_font.file = "";
-        console.gui_font.default_data = font_inconsolata;
-        load_font (json, console.gui_font);
-
-        console.log_font.name = "Log";
-        console.log_font.scale = 1.f;
-        console.log_font.size = 32.f;
-        console.log_font.color = IM_COL32_WHITE;
-        console.log_font.file = "";
-        console.log_font.default_data = font_inconsolata;
-        load_font (json, console.log_font);
-
-        console.prompt_color = IM_COL32 (0, 192, 0, 255);
-        console.out_color = IM_COL32 (255, 255, 255, 255);
-        console.in_color = IM_COL32 (192, 192, 192, 255);
-        if (json.contains ("Log colors"))
-        {
-            auto const& j = json["Log colors"];
-            console.prompt_color = std::stoul (
-                    j.value ("prompt", hex_string (console.prompt_color)), nullptr, 0);
-            console.out_color = std::stoul (
-                    j.value ("out", hex_string (console.out_color)), nullptr, 0);
-            console.in_color = std::stoul (
-                    j.value ("in", hex_string (console.in_color)), nullptr, 0);
-        }
-
-        console.help_names_color = IM_COL32 (255, 255, 255, 255);
-        console.help_params_color = IM_COL32 (128, 128, 128, 255);
-        console.help_brief_color = IM_COL32 (192, 192, 192, 255);
-        console.help_details_color = IM_COL32 (128, 128, 128, 255);
-        if (json.contains ("Help colors"))
-        {
-            auto const& j = json["Help colors"];
-            console.help_names_color = std::stoul (
-                    j.value ("names", hex_string (console.help_names_color)), nullptr, 0);
-            console.help_params_color = std::stoul (
-                    j.value ("params", hex_string (console.help_params_color)), nullptr, 0);
-            console.help_brief_color = std::stoul (
-                    j.value ("brief", hex_string (console.help_brief_color)), nullptr, 0);
-            console.help_details_color = std::stoul (
-                    j.value ("details", hex_string (console.help_details_color)), nullptr, 0);
-        }
-
-        console.execution_delay = json.value ("Execution delay", 100);
-    }
-    catch (std::exception const& ex)
-    {
-        log () << "Unable to load settings file: " << ex.what () << std::endl;
-        return false;
-    }
-    return true;
-}
-
-//--------------------------------------------------------------------------------------------------
-
 bool
 save_aliases ()
 {
@@ -354,6 +309,7 @@ load_help_file (
                 auto n = jn.get<std::string> ();
                 if (trim_both (n, ' ').empty ())
                     continue;
+                completers.push_back (n);
                 if (gotn)
                     n = " " + n; // To look better when displayed in the GUI
                 else
@@ -362,7 +318,6 @@ load_help_file (
                     i.begin = data.size ();
                 }
                 append_to_help (n, help_index::names_size);
-                completers.emplace_back (std::move (n));
             }
             if (!gotn)
                 throw std::runtime_error ("Missing valid 'names'.");
@@ -383,10 +338,6 @@ load_help_file (
             indexes.push_back (i);
         }
 
-        /// Likely SSO, so speed more or less is fine, nor are many completers expected
-        std::sort (completers.begin (), completers.end ());
-        completers.erase (std::unique (completers.begin (), completers.end ()), completers.end ());
-
         std::sort (indexes.begin (), indexes.end (), [&] (auto const& a, auto const& b) {
                 return std::string_view (&data[a.begin], a.params)
                      < std::string_view (&data[b.begin], b.params);
@@ -422,7 +373,8 @@ load_help_files ()
     if (load_help_file (locations.help_alias, completers, data, indexes))
         console.alias_data.swap (data), console.alias_indexes.swap (indexes);
 
-    console.completers.swap (completers);
+    console.completers.assign (completers);
+    fold_help_copies ();
     return true;
 }
 
@@ -0,0 +1,205 @@
+/**
+ * @file fuzzy.cpp
+ * @brief Fuzzy matching of mistyped names, ranked by a score
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "fuzzy.hpp"
+#include "search.hpp"
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------------------
+
+/// The scores of fzf, its first version of the algorithm
+enum : int {
+    score_match = 16,
+    score_gap_start = -3,
+    score_gap_extension = -1,
+    bonus_boundary = score_match / 2,
+    bonus_non_word = score_match / 2,
+    bonus_camel = bonus_boundary + score_gap_extension,
+    bonus_consecutive = -(score_gap_start + score_gap_extension),
+    bonus_first_char = 2
+};
+
+enum char_class { non_word, lower, upper, digit };
+
+static char_class
+classify (char c)
+{
+    return c >= 'a' && c <= 'z' ? lower : c >= 'A' && c <= 'Z' ? upper
+         : c >= '0' && c <= '9' ? digit : non_word;
+}
+
+/// Of a character matched right after the given one
+static int
+bonus (char_class previous, char_class current)
+{
+    if (previous == non_word && current != non_word)
+        return bonus_boundary;
+    if ((previous == lower && current == upper)
+            || (previous != digit && current == digit))
+        return bonus_camel;
+    return current == non_word ? bonus_non_word : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint64_t
+fuzzy_mask (std::string_view text)
+{
+    std::uint64_t m = 0;
+    for (char c: text)
+    {
+        c = fold_ascii (c);
+        unsigned bit = c >= 'a' && c <= 'z' ? unsigned (c - 'a')
+                     : c >= '0' && c <= '9' ? 26 + unsigned (c - '0')
+                     : 36 + std::uint8_t (c) % 28;
+        m |= std::uint64_t (1) << bit;
+    }
+    return m;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+fuzzy_pattern::fuzzy_pattern (std::string_view pattern)
+    : chars (fuzzy_mask (pattern))
+{
+    for (char c: pattern)
+        folded.push_back (fold_ascii (c));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * The first match forward gives the end, then matching backward from it gives the latest start,
+ * hence the shortest part ending there, which is then scored.
+ */
+
+bool
+fuzzy_pattern::score (std::string_view text, std::uint64_t text_mask, match& result) const
+{
+    if (folded.empty () || (chars & ~text_mask))
+        return false;
+
+    std::size_t p = 0, end = 0;
+    for (std::size_t i = 0; i < text.size () && p < folded.size (); ++i)
+        if (fold_ascii (text[i]) == folded[p] && ++p == folded.size ())
+            end = i + 1;
+    if (p < folded.size ())
+        return false;
+
+    std::size_t start = end;
+    for (p = folded.size (); p > 0; )
+        if (fold_ascii (text[--start]) == folded[p-1])
+            --p;
+
+    int score = 0, first_bonus = 0;
+    bool in_gap = false;
+    std::size_t consecutive = 0;
+    auto previous = start ? classify (text[start-1]) : non_word;
+    for (std::size_t i = start; i < end; ++i)
+    {
+        auto current = classify (text[i]);
+        if (fold_ascii (text[i]) == folded[p])
+        {
+            score += score_match;
+            int b = bonus (previous, current);
+            if (!consecutive)
+                first_bonus = b;
+            else
+            {
+                // A run keeps the bonus of its start, unless a better boundary is within it
+                if (b >= bonus_boundary && b > first_bonus)
+                    first_bonus = b;
+                b = std::max ({ b, first_bonus, int (bonus_consecutive) });
+            }
+            score += p ? b : b * bonus_first_char;
+            in_gap = false;
+            ++consecutive;
+            ++p;
+        }
+        else
+        {
+            score += in_gap ? score_gap_extension : score_gap_start;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+        previous = current;
+    }
+
+    result = match { score, start, end - start };
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Whether the first is worse than the second one, as the heap top is the worst kept
+
+static bool
+worse (fuzzy_top::entry const& a, fuzzy_top::entry const& b)
+{
+    if (a.score != b.score)
+        return a.score < b.score;
+    if (a.length != b.length)
+        return a.length > b.length;
+    return a.order > b.order;
+}
+
+static bool
+better (fuzzy_top::entry const& a, fuzzy_top::entry const& b)
+{
+    return worse (b, a);
+}
+
+void
+fuzzy_top::push (int score, std::size_t length, std::uint32_t key)
+{
+    entry e { score, std::uint32_t (length), key, pushed++ };
+    if (heap.size () < limit)
+    {
+        heap.push_back (e);
+        std::push_heap (heap.begin (), heap.end (), better);
+    }
+    else if (limit && worse (heap.front (), e))
+    {
+        std::pop_heap (heap.begin (), heap.end (), better);
+        heap.back () = e;
+        std::push_heap (heap.begin (), heap.end (), better);
+    }
+}
+
+std::vector<fuzzy_top::entry>
+fuzzy_top::take ()
+{
+    std::sort_heap (heap.begin (), heap.end (), better);
+    std::vector<entry> r;
+    r.swap (heap);
+    pushed = 0;
+    return r;
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,123 @@
+/**
+ * @file fuzzy.hpp
+ * @brief Fuzzy matching of mistyped names, ranked by a score
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * As in fzf, a name matches if it has the typed characters in the same order, ignoring the case
+ * of the ASCII letters, e.g. "addtem" matches "AddItem". The shortest such part of the name is
+ * scored: each matched character gains, more so at the start of a word or of a camel case hump
+ * and right after another matched one, while each skipped character in between costs. So the
+ * closer names score higher, and only the best few of them are kept by a #fuzzy_top.
+ *
+ * Before scoring, a name must have all of the pattern characters, which a single AND of their
+ * #fuzzy_mask tells, so the masks of the names are best made once, along with them.
+ */
+
+#ifndef SSE_CONSOLE_FUZZY_HPP
+#define SSE_CONSOLE_FUZZY_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//--------------------------------------------------------------------------------------------------
+
+/// Set of the characters in the text, one bit per letter (of any case) or digit, the rest sharing
+std::uint64_t fuzzy_mask (std::string_view text);
+
+//--------------------------------------------------------------------------------------------------
+
+class fuzzy_pattern
+{
+public:
+
+    explicit fuzzy_pattern (std::string_view pattern);
+
+    bool empty () const {
+        return folded.empty ();
+    }
+
+    /// Of the pattern characters, which a text must all have to match, see fuzzy_mask()
+    std::uint64_t mask () const {
+        return chars;
+    }
+
+    /// Where the best scored part of the text is
+    struct match
+    {
+        int score;
+        std::size_t offset, length;
+    };
+
+    /// False if the text has not the pattern characters in order
+    bool score (std::string_view text, std::uint64_t text_mask, match& result) const;
+
+    bool score (std::string_view text, match& result) const {
+        return score (text, fuzzy_mask (text), result);
+    }
+
+private:
+
+    std::string folded;
+    std::uint64_t chars;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * The best scored of any number of pushed candidates, as a bounded min-heap, so the rest are never
+ * sorted. The same score goes to the shorter text, then to the candidate pushed first.
+ */
+
+class fuzzy_top
+{
+public:
+
+    struct entry
+    {
+        int score;
+        std::uint32_t length;           ///< Of the whole text
+        std::uint32_t key;              ///< Of the candidate, as given
+        std::uint32_t order;
+    };
+
+    explicit fuzzy_top (std::size_t capacity) : limit (capacity) {}
+
+    void push (int score, std::size_t length, std::uint32_t key);
+
+    /// The best first, emptying the heap
+    std::vector<entry> take ();
+
+private:
+
+    std::size_t limit;
+    std::uint32_t pushed = 0;
+    std::vector<entry> heap;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_FUZZY_HPP
+
@@ -29,7 +29,7 @@
 #include <utils/winutils.hpp>
 #include <utils/plugin.hpp>
 #include <sse-hooks/sse-hooks.h>
-#include "console.hpp"
+#include "platform.hpp"
 
 //--------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,274 @@
+/**
+ * @file ordinals.cpp
+ * @brief Compressed sets of record ordinals, as the cached filter results
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "ordinals.hpp"
+#include <algorithm>
+#include <iterator>
+
+//--------------------------------------------------------------------------------------------------
+
+static constexpr std::size_t bitmap_words = 65536 / 64;
+
+/// The first set bit at or after that, or 65536 if none
+
+static std::uint32_t
+next_bit (std::vector<std::uint64_t> const& bits, std::uint32_t from)
+{
+    if (from >= 65536)
+        return 65536;
+    std::size_t w = from / 64;
+    auto word = bits[w] & (~std::uint64_t (0) << (from % 64));
+    while (!word)
+    {
+        if (++w == bitmap_words)
+            return 65536;
+        word = bits[w];
+    }
+    return std::uint32_t (w * 64 + __builtin_ctzll (word));
+}
+
+static std::uint32_t
+count_bits (std::vector<std::uint64_t> const& bits)
+{
+    std::uint32_t n = 0;
+    for (auto w: bits)
+        n += std::uint32_t (__builtin_popcountll (w));
+    return n;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+ordinal_set::const_iterator::settle ()
+{
+    for (; index < containers->size (); ++index, low = 0)
+    {
+        auto const& c = (*containers)[index];
+        if (c.bits.empty () ? low < c.array.size () : (low = next_bit (c.bits, low)) < 65536)
+        {
+            value = std::uint32_t (c.key) << 16 | (c.bits.empty () ? c.array[low] : low);
+            return;
+        }
+    }
+    low = 0;
+}
+
+void
+ordinal_set::const_iterator::advance ()
+{
+    if (!(*containers)[index].bits.empty ())
+        ++low;
+    settle ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ordinal_set::const_iterator
+ordinal_set::begin () const
+{
+    const_iterator i;
+    i.containers = &containers;
+    i.index = 0;
+    i.low = 0;
+    i.settle ();
+    return i;
+}
+
+ordinal_set::const_iterator
+ordinal_set::end () const
+{
+    const_iterator i;
+    i.containers = &containers;
+    i.index = containers.size ();
+    i.low = 0;
+    return i;
+}
+
+ordinal_set::const_iterator
+ordinal_set::lower_bound (std::uint32_t ordinal) const
+{
+    std::uint16_t key = ordinal >> 16, low = ordinal & 0xffff;
+    auto c = std::lower_bound (containers.begin (), containers.end (), key,
+            [] (container const& c, std::uint16_t k) { return c.key < k; });
+
+    const_iterator i;
+    i.containers = &containers;
+    i.index = std::size_t (c - containers.begin ());
+    i.low = 0;
+    if (c != containers.end () && c->key == key)
+        i.low = c->bits.empty () ? std::uint32_t (
+                std::lower_bound (c->array.begin (), c->array.end (), low) - c->array.begin ())
+            : low;
+    i.settle ();
+    return i;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Once the array is full, it is turned to a bitmap. The previous container won't change anymore.
+
+void
+ordinal_set::push_back_slow (std::uint32_t ordinal)
+{
+    std::uint16_t key = ordinal >> 16, low = ordinal & 0xffff;
+    if (containers.empty () || containers.back ().key != key)
+    {
+        if (!containers.empty ())
+            containers.back ().array.shrink_to_fit ();
+        containers.push_back (container { key, 0, {}, {} });
+    }
+
+    auto& c = containers.back ();
+    if (c.bits.empty () && c.array.size () >= array_limit)
+    {
+        c.bits.assign (bitmap_words, 0);
+        for (auto a: c.array)
+            c.bits[a / 64] |= std::uint64_t (1) << (a % 64);
+        std::vector<std::uint16_t> ().swap (c.array);
+    }
+    if (c.bits.empty ())
+        c.array.push_back (low);
+    else
+        c.bits[low / 64] |= std::uint64_t (1) << (low % 64);
+    ++c.count;
+    ++count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+ordinal_set::erase_below (std::uint32_t ordinal)
+{
+    std::uint16_t key = ordinal >> 16, low = ordinal & 0xffff;
+    auto c = std::lower_bound (containers.begin (), containers.end (), key,
+            [] (container const& c, std::uint16_t k) { return c.key < k; });
+    for (auto i = containers.begin (); i != c; ++i)
+        count -= i->count;
+    c = containers.erase (containers.begin (), c);
+    if (c == containers.end () || c->key != key)
+        return;
+
+    count -= c->count;
+    if (c->bits.empty ())
+        c->array.erase (c->array.begin (),
+                std::lower_bound (c->array.begin (), c->array.end (), low));
+    else
+    {
+        std::fill (c->bits.begin (), c->bits.begin () + low / 64, 0);
+        c->bits[low / 64] &= ~std::uint64_t (0) << (low % 64);
+    }
+    c->count = c->bits.empty () ? std::uint32_t (c->array.size ()) : count_bits (c->bits);
+    count += c->count;
+    if (!c->count)
+        containers.erase (c);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+ordinal_set::clear ()
+{
+    containers.clear ();
+    count = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ordinal_set&
+ordinal_set::operator &= (ordinal_set const& other)
+{
+    if (this == &other)
+        return *this;
+
+    std::vector<container> result;
+    auto a = containers.begin ();
+    auto b = other.containers.begin ();
+    while (a != containers.end () && b != other.containers.end ())
+    {
+        if (a->key < b->key)
+        {
+            ++a;
+            continue;
+        }
+        if (b->key < a->key)
+        {
+            ++b;
+            continue;
+        }
+
+        container c { a->key, 0, {}, {} };
+        if (!a->bits.empty () && !b->bits.empty ())
+        {
+            c.bits = std::move (a->bits);
+            for (std::size_t w = 0; w < bitmap_words; ++w)
+                c.bits[w] &= b->bits[w];
+            c.count = count_bits (c.bits);
+            if (c.count <= array_limit)
+            {
+                for (auto i = next_bit (c.bits, 0); i < 65536; i = next_bit (c.bits, i + 1))
+                    c.array.push_back (std::uint16_t (i));
+                std::vector<std::uint64_t> ().swap (c.bits);
+            }
+        }
+        else if (a->bits.empty () && b->bits.empty ())
+            std::set_intersection (a->array.begin (), a->array.end (),
+                    b->array.begin (), b->array.end (), std::back_inserter (c.array));
+        else
+        {
+            auto const& array = a->bits.empty () ? a->array : b->array;
+            auto const& bits = a->bits.empty () ? b->bits : a->bits;
+            std::copy_if (array.begin (), array.end (), std::back_inserter (c.array),
+                    [&bits] (std::uint16_t i) { return bits[i / 64] >> (i % 64) & 1; });
+        }
+        if (c.bits.empty ())
+            c.count = std::uint32_t (c.array.size ()), c.array.shrink_to_fit ();
+        if (c.count)
+            result.push_back (std::move (c));
+        ++a, ++b;
+    }
+
+    containers.swap (result);
+    count = 0;
+    for (auto const& c: containers)
+        count += c.count;
+    return *this;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t
+ordinal_set::memory () const
+{
+    std::size_t n = containers.capacity () * sizeof (container);
+    for (auto const& c: containers)
+        n += c.array.capacity () * sizeof (std::uint16_t)
+           + c.bits.capacity () * sizeof (std::uint64_t);
+    return n;
+}
+
+//--------------------------------------------------------------------------------------------------
+
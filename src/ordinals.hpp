@@ -0,0 +1,151 @@
+/**
+ * @file ordinals.hpp
+ * @brief Compressed sets of record ordinals, as the cached filter results
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * Like the Roaring bitmaps, the ordinals are split by their upper 16 bits into containers, each
+ * holding the lower 16 bits either as a sorted array, while there are few of them, or as a
+ * bitmap of 8 KiB once the array would be larger. A sparse result takes about 2 bytes per record,
+ * a dense one about 1 bit per record of the source, instead of a whole record index either way.
+ * The intersection works a container at a time, as merge of the arrays, look up of an array in
+ * a bitmap, or a bitwise AND of the bitmaps.
+ */
+
+#ifndef SSE_CONSOLE_ORDINALS_HPP
+#define SSE_CONSOLE_ORDINALS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//--------------------------------------------------------------------------------------------------
+
+class ordinal_set
+{
+    struct container
+    {
+        std::uint16_t key;                  ///< Upper bits of the ordinals
+        std::uint32_t count;
+        std::vector<std::uint16_t> array;   ///< Sorted lower bits, if not in the bitmap
+        std::vector<std::uint64_t> bits;    ///< Of all the lower bits, or empty
+    };
+
+public:
+
+    /// Arrays up to that many take less than a bitmap
+    static constexpr std::size_t array_limit = 4096;
+
+    class const_iterator
+    {
+    public:
+
+        std::uint32_t operator * () const {
+            return value;
+        }
+
+        const_iterator& operator ++ ()
+        {
+            // Inline while within an array, the rest is out of line
+            auto const& c = (*containers)[index];
+            if (c.bits.empty () && ++low < c.array.size ())
+                value = (value & ~0xffffu) | c.array[low];
+            else
+                advance ();
+            return *this;
+        }
+
+        bool operator == (const_iterator const& o) const {
+            return index == o.index && low == o.low;
+        }
+
+    private:
+
+        friend class ordinal_set;
+        std::vector<container> const* containers;
+        std::size_t index;          ///< Of the container
+        std::uint32_t low;          ///< Position in the array, or bit in the bitmap
+        std::uint32_t value;
+
+        void settle ();
+        void advance ();
+    };
+
+    /// The ordinal must be greater than all already in
+    void push_back (std::uint32_t ordinal)
+    {
+        // Inline into the last container, the rest is out of line
+        if (!containers.empty ())
+        {
+            auto& c = containers.back ();
+            if (c.key == ordinal >> 16 && (!c.bits.empty () || c.array.size () < array_limit))
+            {
+                std::uint16_t low = ordinal & 0xffff;
+                if (c.bits.empty ())
+                    c.array.push_back (low);
+                else
+                    c.bits[low / 64] |= std::uint64_t (1) << (low % 64);
+                ++c.count;
+                ++count;
+                return;
+            }
+        }
+        push_back_slow (ordinal);
+    }
+
+    /// Removes the ordinals less than that
+    void erase_below (std::uint32_t ordinal);
+
+    void clear ();
+
+    std::size_t size () const {
+        return count;
+    }
+
+    bool empty () const {
+        return !count;
+    }
+
+    const_iterator begin () const;
+    const_iterator end () const;
+
+    /// The first ordinal not less than that
+    const_iterator lower_bound (std::uint32_t ordinal) const;
+
+    /// Keeps only the ordinals also in the other set
+    ordinal_set& operator &= (ordinal_set const& other);
+
+    /// Approximate bytes held
+    std::size_t memory () const;
+
+private:
+
+    std::vector<container> containers;
+    std::size_t count = 0;
+
+    void push_back_slow (std::uint32_t ordinal);
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_ORDINALS_HPP
+
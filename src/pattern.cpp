@@ -0,0 +1,694 @@
+/**
+ * @file pattern.cpp
+ * @brief Regular expression and glob filters, compiled to a DFA over the ASCII folded bytes
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "pattern.hpp"
+#include <bitset>
+#include <map>
+#include <algorithm>
+#include <utility>
+
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr std::size_t max_nodes = 8192;     ///< Of the NFA, bounding the {m,n} copies
+constexpr std::size_t max_states = 4096;    ///< Of the DFA, as it may explode on some patterns
+constexpr int max_repeat = 255;
+
+typedef std::bitset<256> byte_set;
+
+byte_set
+range_set (int first, int last)
+{
+    byte_set s;
+    for (int b = first; b <= last; ++b)
+        s.set (b);
+    return s;
+}
+
+/// Only the folded bytes get looked up, so the sets are made of these too
+byte_set
+folded (byte_set const& s, bool negate)
+{
+    byte_set f;
+    for (int b = 0; b < 256; ++b)
+        if (s.test (b))
+            f.set (std::uint8_t (fold_ascii (char (b))));
+    return negate ? ~f : f;
+}
+
+/// The "\d", "\w" and "\s" sets, or none
+bool
+escape_set (char c, byte_set& s)
+{
+    switch (fold_ascii (c))
+    {
+        case 'd': s = range_set ('0', '9'); break;
+        case 'w': s = range_set ('0', '9') | range_set ('a', 'z') | range_set ('A', 'Z')
+                    | range_set ('_', '_'); break;
+        case 's': s = range_set (' ', ' ') | range_set ('\t', '\r'); break;
+        default: return false;
+    }
+    s = folded (s, c >= 'A' && c <= 'Z');
+    return true;
+}
+
+/// The "\n", "\t", "\r", "\f" and "\v" bytes, or -1
+int
+control_escape (char c)
+{
+    switch (c)
+    {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'f': return '\f';
+        case 'v': return '\v';
+        default: return -1;
+    }
+}
+
+/// Any other escaped letter or digit is likely meant as something not known here, e.g. "\x41"
+bool
+alphanumeric (char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/// Of the "\b" word boundaries
+bool
+word_byte (int b)
+{
+    return (b >= '0' && b <= '9') || (b >= 'a' && b <= 'z') || (b >= 'A' && b <= 'Z') || b == '_';
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Thompson's construction, where the splits, the jumps and the anchors are the empty transitions,
+/// the "^" and "$" ones only at the start or at the end of the text, the "\b" and "\B" ones only
+/// between bytes of a different or of the same kind, as word bytes or not
+
+struct nfa_node
+{
+    enum kind_type { bytes, split, jump, at_start, at_end, at_boundary, off_boundary, accept } kind;
+    byte_set set;       ///< Of folded bytes, for the #bytes kind
+    int out = -1, alt = -1;
+};
+
+/// The start node and the transitions still to be pointed to what follows
+struct fragment
+{
+    int start;
+    std::vector<std::pair<int, bool>> ends; ///< Node and if its #nfa_node::alt is meant
+};
+
+class regex_parser
+{
+public:
+
+    std::vector<nfa_node> nodes;
+    std::string error;
+    std::string required;   ///< Longest literal of the top level sequence
+    bool boundaries = false;    ///< If any "\b" or "\B"
+
+    regex_parser (std::string_view pattern) : text (pattern) {}
+
+    /// Returns the start node, or -1 on error
+    int parse ()
+    {
+        auto f = alternatives (0);
+        if (error.empty () && pos < text.size ())
+            fail ("unmatched )");
+        commit ();
+        if (top_alternatives)
+            required.clear ();
+        if (!error.empty ())
+            return -1;
+        patch (f, add ({ nfa_node::accept }));
+        return error.empty () ? f.start : -1;
+    }
+
+private:
+
+    std::string_view text;
+    std::size_t pos = 0;
+    std::string run;
+    bool top_alternatives = false;
+
+    void fail (const char* what)
+    {
+        if (error.empty ())
+            error = what;
+        pos = text.size ();
+    }
+
+    int add (nfa_node n)
+    {
+        if (nodes.size () >= max_nodes)
+        {
+            fail ("too long");
+            return 0;
+        }
+        nodes.push_back (n);
+        return int (nodes.size () - 1);
+    }
+
+    void patch (fragment const& f, int target)
+    {
+        if (!error.empty ())
+            return;
+        for (auto [n, alt]: f.ends)
+            (alt ? nodes[n].alt : nodes[n].out) = target;
+    }
+
+    fragment single (byte_set const& s)
+    {
+        auto n = add ({ nfa_node::bytes, s });
+        return { n, { { n, false } } };
+    }
+
+    fragment empty (nfa_node::kind_type kind = nfa_node::jump)
+    {
+        auto n = add ({ kind });
+        return { n, { { n, false } } };
+    }
+
+    void concat (std::optional<fragment>& f, fragment&& next)
+    {
+        if (!f)
+            f = std::move (next);
+        else
+        {
+            patch (*f, next.start);
+            f->ends = std::move (next.ends);
+        }
+    }
+
+    void commit ()
+    {
+        if (run.size () > required.size ())
+            required = run;
+        run.clear ();
+    }
+
+    fragment alternatives (int depth)
+    {
+        auto f = sequence (depth);
+        while (pos < text.size () && text[pos] == '|')
+        {
+            ++pos;
+            if (!depth)
+                top_alternatives = true;
+            auto g = sequence (depth);
+            auto s = add ({ nfa_node::split });
+            if (!error.empty ())
+                break;
+            nodes[s].out = f.start;
+            nodes[s].alt = g.start;
+            f.start = s;
+            f.ends.insert (f.ends.end (), g.ends.begin (), g.ends.end ());
+        }
+        return f;
+    }
+
+    fragment sequence (int depth)
+    {
+        std::optional<fragment> f;
+        while (pos < text.size () && text[pos] != '|' && text[pos] != ')')
+        {
+            auto begin = pos;
+            int literal;
+            auto a = atom (depth, literal);
+            auto q = quantifier (std::move (a), begin, pos, depth, literal);
+            concat (f, std::move (q));
+        }
+        if (!depth)
+            commit ();
+        return f ? std::move (*f) : empty ();
+    }
+
+    /// The literal is the folded byte, if the atom is just that
+    fragment atom (int depth, int& literal)
+    {
+        literal = -1;
+        char c = text[pos++];
+        byte_set s;
+        switch (c)
+        {
+            case '(':
+            {
+                auto f = alternatives (depth + 1);
+                if (pos >= text.size () || text[pos] != ')')
+                    fail ("missing )");
+                else
+                    ++pos;
+                return f;
+            }
+            case '[':
+                return single (byte_class ());
+            case '.':
+                return single (~byte_set ());
+            case '^':
+                return empty (nfa_node::at_start);
+            case '$':
+                return empty (nfa_node::at_end);
+            case '*': case '+': case '?': case '{':
+                fail ("nothing to repeat");
+                return empty ();
+            case '\\':
+                if (pos >= text.size ())
+                {
+                    fail ("trailing \\");
+                    return empty ();
+                }
+                c = text[pos++];
+                if (escape_set (c, s))
+                    return single (s);
+                if (c == 'b' || c == 'B')
+                {
+                    boundaries = true;
+                    return empty (c == 'b' ? nfa_node::at_boundary : nfa_node::off_boundary);
+                }
+                if (auto b = control_escape (c); b >= 0)
+                    c = char (b);
+                else if (alphanumeric (c))
+                {
+                    fail ("unknown escape");
+                    return empty ();
+                }
+                [[fallthrough]];
+            default:
+                literal = std::uint8_t (fold_ascii (c));
+                s.set (std::uint8_t (c));
+                return single (folded (s, false));
+        }
+    }
+
+    /// Within a class, "\b" is the backspace, as in the other dialects
+    int class_escape (char c)
+    {
+        if (auto b = control_escape (c); b >= 0)
+            return b;
+        if (c == 'b')
+            return '\b';
+        if (alphanumeric (c))
+            fail ("unknown escape");
+        return std::uint8_t (c);
+    }
+
+    byte_set byte_class ()
+    {
+        byte_set s;
+        bool negate = pos < text.size () && text[pos] == '^';
+        pos += negate;
+        for (bool first = true; pos < text.size () && (first || text[pos] != ']'); first = false)
+        {
+            int lo = std::uint8_t (text[pos++]);
+            if (lo == '\\' && pos < text.size ())
+            {
+                byte_set e;
+                if (escape_set (text[pos], e))
+                {
+                    s |= e;
+                    ++pos;
+                    continue;
+                }
+                lo = class_escape (text[pos++]);
+            }
+            int hi = lo;
+            if (pos + 1 < text.size () && text[pos] == '-' && text[pos+1] != ']')
+            {
+                hi = std::uint8_t (text[pos+1]);
+                pos += 2;
+                if (hi == '\\' && pos < text.size ())
+                    hi = class_escape (text[pos++]);
+                if (hi < lo)
+                {
+                    fail ("bad range");
+                    break;
+                }
+            }
+            s |= range_set (lo, hi);
+        }
+        if (pos >= text.size ())
+            fail ("missing ]");
+        else
+            ++pos;
+        return folded (s, negate);
+    }
+
+    /// Parses "{m}", "{m,}" or "{m,n}", -1 for no upper bound
+    bool bounds (int& m, int& n)
+    {
+        auto number = [this] (int& v)
+        {
+            auto begin = pos;
+            for (v = 0; pos < text.size () && text[pos] >= '0' && text[pos] <= '9'; ++pos)
+                v = std::min (v * 10 + (text[pos] - '0'), max_repeat + 1);
+            return pos != begin;
+        };
+        ++pos;
+        if (!number (m))
+            return false;
+        n = m;
+        if (pos < text.size () && text[pos] == ',')
+        {
+            ++pos;
+            if (!number (n))
+                n = -1;
+        }
+        if (pos >= text.size () || text[pos] != '}' || m > max_repeat || n > max_repeat
+                || (n >= 0 && n < m))
+            return false;
+        ++pos;
+        return true;
+    }
+
+    /// Another copy of the atom, by parsing it again
+    fragment copy (std::size_t begin, std::size_t end, int depth)
+    {
+        auto saved = std::exchange (pos, begin);
+        int literal;
+        auto f = atom (depth + 1, literal);
+        if (pos != end)
+            fail ("bad repeat");
+        pos = saved;
+        return f;
+    }
+
+    fragment star (fragment&& a)
+    {
+        auto s = add ({ nfa_node::split });
+        if (!error.empty ())
+            return a;
+        nodes[s].out = a.start;
+        patch (a, s);
+        return { s, { { s, true } } };
+    }
+
+    fragment optional (fragment&& a)
+    {
+        auto s = add ({ nfa_node::split });
+        if (!error.empty ())
+            return a;
+        nodes[s].out = a.start;
+        a.ends.emplace_back (s, true);
+        return { s, std::move (a.ends) };
+    }
+
+    fragment quantifier (fragment&& a, std::size_t begin, std::size_t end, int depth, int literal)
+    {
+        char q = pos < text.size () ? text[pos] : 0;
+        int m = 1, n = 1;
+        if (q == '*' || q == '+' || q == '?')
+            ++pos, m = q == '+', n = q == '?' ? 1 : -1;
+        else if (q == '{' && !bounds (m, n))
+            fail ("bad {m,n}");
+
+        // The mandatory literals of the top level make the prefilter
+        if (!depth)
+        {
+            if (literal >= 0 && m > 0)
+                run.push_back (char (literal));
+            if (literal < 0 || m != 1 || n != 1)
+                commit ();
+        }
+        if (m == 1 && n == 1)
+            return std::move (a);
+
+        std::optional<fragment> f;
+        bool first = true;
+        auto next = [&] {
+            return std::exchange (first, false) ? std::move (a) : copy (begin, end, depth);
+        };
+        for (int i = 0; i < m && error.empty (); ++i)
+            concat (f, next ());
+        if (n < 0)
+            concat (f, star (next ()));
+        else for (int i = m; i < n && error.empty (); ++i)
+            concat (f, optional (next ()));
+        return f ? std::move (*f) : empty ();
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// Same as an expression, with whatever else escaped
+std::string
+glob_to_regex (std::string_view glob)
+{
+    std::string re;
+    for (std::size_t i = 0; i < glob.size (); ++i)
+    {
+        char c = glob[i];
+        if (c == '*')
+            re += ".*";
+        else if (c == '?')
+            re += '.';
+        else if (auto close = glob.find (']', i + 2 + (glob.substr (i + 1, 1) == "!"));
+                c == '[' && close != std::string_view::npos)
+        {
+            re += '[';
+            if (glob[++i] == '!')
+                re += '^', ++i;
+            for (; i < close; ++i)
+            {
+                if (glob[i] == '\\' || glob[i] == '[' || glob[i] == '^')
+                    re += '\\';
+                re += glob[i];
+            }
+            re += ']';
+        }
+        else
+        {
+            if (c == '\\' && i + 1 < glob.size ())
+                c = glob[++i];
+            if (std::string_view (".()|+{}^$\\[]*?").find (c) != std::string_view::npos)
+                re += '\\';
+            re += c;
+        }
+    }
+    return re;
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+std::string
+text_pattern::compile (std::string_view pattern, syntax_type syntax)
+{
+    table.clear ();
+    flags.clear ();
+    required.clear ();
+    prefilter.reset ();
+
+    std::string re;
+    if (syntax == glob)
+        pattern = re = glob_to_regex (pattern);
+
+    regex_parser parser (pattern);
+    int start = parser.parse ();
+    if (start < 0)
+        return parser.error;
+    auto const& nodes = parser.nodes;
+
+    // Bytes which no set tells apart make a class
+    std::map<std::vector<bool>, std::uint8_t> signatures;
+    std::array<std::uint8_t, 256> folded_class;
+    std::vector<std::uint8_t> representative;
+    for (int b = 0; b < 256; ++b)
+    {
+        if (fold_ascii (char (b)) != char (b))
+            continue;
+        std::vector<bool> signature;
+        for (auto const& n: nodes)
+            if (n.kind == nfa_node::bytes)
+                signature.push_back (n.set.test (b));
+        if (parser.boundaries)
+            signature.push_back (word_byte (b));
+        auto [it, added] = signatures.emplace (signature, std::uint8_t (representative.size ()));
+        if (added)
+            representative.push_back (std::uint8_t (b));
+        folded_class[b] = it->second;
+    }
+    for (int b = 0; b < 256; ++b)
+        classes[b] = folded_class[std::uint8_t (fold_ascii (char (b)))];
+    class_count = representative.size ();
+
+    // Subset construction, each state being the byte matching, the "$", the "\b", the "\B" and
+    // the accept nodes it is at. The "^" ones are passed only at the start, so that the states of
+    // an anchored pattern which can't match anymore are the same, dead, one. The first state is
+    // told apart, as are the states after a word byte, if there are any "\b" or "\B" nodes. These
+    // are passed only once the next byte, or the end, tells if there is a boundary.
+    std::vector<char> visited (nodes.size ());
+    auto closure = [&] (std::vector<int> stack, bool at_start, bool at_end, int boundary = -1)
+    {
+        std::vector<int> set;
+        std::fill (visited.begin (), visited.end (), 0);
+        while (!stack.empty ())
+        {
+            int i = stack.back ();
+            stack.pop_back ();
+            if (i < 0 || visited[i])
+                continue;
+            visited[i] = 1;
+            auto const& n = nodes[i];
+            if (n.kind == nfa_node::split || n.kind == nfa_node::jump)
+                stack.push_back (n.alt), stack.push_back (n.out);
+            else if (n.kind == nfa_node::at_start)
+            {
+                if (at_start)
+                    stack.push_back (n.out);
+            }
+            else if (n.kind == nfa_node::at_end && at_end)
+                stack.push_back (n.out);
+            else if ((n.kind == nfa_node::at_boundary && boundary == 1)
+                    || (n.kind == nfa_node::off_boundary && boundary == 0))
+                stack.push_back (n.out);
+            else if ((n.kind == nfa_node::at_boundary || n.kind == nfa_node::off_boundary)
+                    && boundary >= 0)
+                continue;
+            else
+                set.push_back (i);
+        }
+        std::sort (set.begin (), set.end ());
+        return set;
+    };
+
+    std::map<std::vector<int>, std::uint16_t> ids;
+    std::vector<std::vector<int>> states;
+    auto intern = [&] (std::vector<int>&& set) -> std::uint16_t
+    {
+        auto it = ids.find (set);
+        if (it != ids.end ())
+            return it->second;
+        auto id = std::uint16_t (states.size ());
+        ids.emplace (set, id);
+        states.push_back (std::move (set));
+        return id;
+    };
+
+    auto accept = int (std::find_if (nodes.begin (), nodes.end (),
+            [] (nfa_node const& n) { return n.kind == nfa_node::accept; }) - nodes.begin ());
+    enum { first_marker = -1, word_marker = -2 };
+    auto first = closure ({ start }, true, false);
+    first.push_back (first_marker);
+    intern (std::move (first));
+    for (std::size_t i = 0; i < states.size (); ++i)
+    {
+        if (states.size () > max_states)
+        {
+            table.clear ();
+            flags.clear ();
+            return "too complex";
+        }
+        auto set = states[i];
+        bool after_word = false;
+        for (; !set.empty () && set.back () < 0; set.pop_back ())
+            after_word |= set.back () == word_marker;
+        auto accepting = [&nodes] (std::vector<int> const& set) {
+            return std::any_of (set.begin (), set.end (),
+                    [&nodes] (int n) { return nodes[n].kind == nfa_node::accept; });
+        };
+        std::uint8_t f = set.empty () ? dead
+            : accepting (set) ? accept_now
+            : accepting (closure (set, !i, true, after_word)) ? accept_at_end : 0;
+        flags.push_back (f);
+
+        table.resize (states.size () * class_count);
+        for (std::size_t c = 0; c < class_count; ++c)
+        {
+            if (f & (accept_now | dead))
+            {
+                table[i * class_count + c] = std::uint16_t (i);
+                continue;
+            }
+            // Past the boundaries before the byte, which may already accept
+            bool word = word_byte (representative[c]);
+            auto const& now = parser.boundaries
+                ? closure (set, !i, false, after_word != word) : set;
+            std::vector<int> next;
+            for (int n: now)
+                if (nodes[n].kind == nfa_node::bytes && nodes[n].set.test (representative[c]))
+                    next.push_back (nodes[n].out);
+            next.push_back (start);
+            if (accepting (now))
+                next = { accept };
+            next = closure (std::move (next), false, false);
+            if (parser.boundaries && word)
+                next.push_back (word_marker);
+            auto id = intern (std::move (next));
+            table.resize (states.size () * class_count);
+            table[i * class_count + c] = id;
+        }
+    }
+
+    required = std::move (parser.required);
+    if (!required.empty ())
+        prefilter.emplace (required);
+    return {};
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<bool Folded>
+bool
+text_pattern::run (const char* first, const char* last) const
+{
+    if (flags.empty ())
+        return false;
+    if (prefilter && !(Folded ? prefilter->contains_folded (first, last)
+                              : prefilter->contains (first, last)))
+        return false;
+
+    std::size_t s = 0;
+    if (flags[s] & (accept_now | dead))
+        return flags[s] & accept_now;
+    for (auto p = first; p != last; ++p)
+    {
+        s = table[s * class_count + classes[std::uint8_t (*p)]];
+        if (flags[s] & (accept_now | dead))
+            return flags[s] & accept_now;
+    }
+    return flags[s] & accept_at_end;
+}
+
+bool
+text_pattern::matches (const char* first, const char* last) const
+{
+    return run<false> (first, last);
+}
+
+bool
+text_pattern::matches_folded (const char* first, const char* last) const
+{
+    return run<true> (first, last);
+}
+
+//--------------------------------------------------------------------------------------------------
+
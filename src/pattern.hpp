@@ -0,0 +1,95 @@
+/**
+ * @file pattern.hpp
+ * @brief Regular expression and glob filters, compiled to a DFA over the ASCII folded bytes
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * The query term "re:<expression>" or "glob:<pattern>" selects a pattern instead of a plain
+ * substring. Either is compiled once into a DFA, over classes of bytes which no part of the
+ * pattern tells apart, so that matching a record is a single pass of table lookups, without any
+ * allocation or backtracking. Like the substrings, the patterns match anywhere in the record and
+ * ignore the case of the ASCII letters.
+ *
+ * The expressions know literals, ".", "[a-z]" classes (also negated with "[^"), the "\d", "\w",
+ * "\s" escapes (and their upper case negations), groups, "|" alternatives and the "*", "+", "?",
+ * "{m}", "{m,}" and "{m,n}" quantifiers, while "^" and "$" match at the start and at the end of
+ * the record. The "\b" and "\B" escapes match at a word boundary or away from one (the start and
+ * the end of the record being non-word), "\n", "\t", "\r", "\f" and "\v" are the control
+ * characters (within a class, "\b" is the backspace), and an escaped punctuation is taken as it
+ * is, while any other escaped letter or digit fails to compile. The globs know "*", "?" and
+ * "[...]" classes (also negated with "[!"), while "\" takes the next character as it is.
+ *
+ * Before running the DFA, a record must contain the longest literal which any match must have,
+ * if there is one, found with #text_search. It is also what an index can look up.
+ */
+
+#ifndef SSE_CONSOLE_PATTERN_HPP
+#define SSE_CONSOLE_PATTERN_HPP
+
+#include "search.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <optional>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------------------
+
+class text_pattern
+{
+public:
+
+    enum syntax_type { regex, glob };
+
+    /// Empty if compiled, otherwise what is wrong with it
+    std::string compile (std::string_view pattern, syntax_type syntax);
+
+    bool matches (const char* first, const char* last) const;
+
+    /// Same as #matches(), but faster for text with the ASCII letters already folded
+    bool matches_folded (const char* first, const char* last) const;
+
+    /// Which any match holds, maybe empty
+    std::string const& literal () const {
+        return required;
+    }
+
+private:
+
+    enum : std::uint8_t { accept_now = 1, accept_at_end = 2, dead = 4 };
+
+    std::array<std::uint8_t, 256> classes;  ///< Of each byte, as folded
+    std::size_t class_count = 0;
+    std::vector<std::uint16_t> table;       ///< Next state, for each state and byte class
+    std::vector<std::uint8_t> flags;        ///< Of each state
+    std::string required;
+    std::optional<text_search> prefilter;
+
+    template<bool Folded>
+    bool run (const char* first, const char* last) const;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_PATTERN_HPP
+
@@ -0,0 +1,66 @@
+/**
+ * @file platform.hpp
+ * @brief Thin layer between the console core and the host it runs within
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * The real thing is in platform_windows.cpp and hooks.cpp, while platform_posix.cpp is a headless
+ * stand-in, so the core can be measured and tested outside the game.
+ */
+
+#ifndef SSE_CONSOLE_PLATFORM_HPP
+#define SSE_CONSOLE_PLATFORM_HPP
+
+#include <string>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------------------
+
+class platform {
+public:
+    /// Period in milliseconds for #execute_queued_command(), zero or less stops it
+    static void update_timer (int period);
+    /// Detached process, optionally with its stdout/stderr redirected to a file
+    static bool create_process (std::string const& command_line, std::string const& output_file);
+};
+
+//--------------------------------------------------------------------------------------------------
+
+class skyrim_log {
+public:
+    static void print (const char* format, ...);
+    static std::string last_message ();
+    static void last_message (std::string const&);
+};
+
+class skyrim_console {
+public:
+    static void execute (std::string const& message);
+    static std::uint32_t selected_form ();
+};
+
+void setup_hooks ();
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_PLATFORM_HPP
+
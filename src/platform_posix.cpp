@@ -0,0 +1,126 @@
+/**
+ * @file platform_posix.cpp
+ * @brief Headless stand-in of platform.hpp for building and measuring outside the game
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * There is no game here: the Skyrim console echoes back each command as its feedback, while the
+ * timer does nothing, as the owner (e.g. a benchmark) calls #execute_queued_command() itself.
+ */
+
+#include "console.hpp"
+#include "platform.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <spawn.h>
+#include <fcntl.h>
+
+extern char** environ;
+
+/// Whatever the "game" printed last
+static std::string last_message_text;
+
+//--------------------------------------------------------------------------------------------------
+
+void
+platform::update_timer (int)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+platform::create_process (std::string const& command_line, std::string const& output_file)
+{
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init (&actions))
+        return false;
+
+    if (output_file.size ())
+    {
+        posix_spawn_file_actions_addopen (&actions, STDOUT_FILENO, output_file.c_str (),
+                O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2 (&actions, STDOUT_FILENO, STDERR_FILENO);
+    }
+
+    // Detached in spirit: nobody waits for it, as with the Windows counterpart
+    pid_t pid;
+    const char* argv[] = { "sh", "-c", command_line.c_str (), nullptr };
+    int err = posix_spawn (&pid, "/bin/sh", &actions, nullptr, const_cast<char**> (argv), environ);
+    posix_spawn_file_actions_destroy (&actions);
+    return err == 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void skyrim_log::print (const char* format, ...)
+{
+    std::va_list args, copy;
+    va_start (args, format);
+    va_copy (copy, args);
+    int n = std::vsnprintf (nullptr, 0, format, copy);
+    va_end (copy);
+    if (n > 0)
+    {
+        last_message_text.resize (std::size_t (n) + 1);
+        std::vsnprintf (last_message_text.data (), last_message_text.size (), format, args);
+        last_message_text.pop_back ();
+    }
+    va_end (args);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::string skyrim_log::last_message ()
+{
+    return last_message_text;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void skyrim_log::last_message (std::string const& msg)
+{
+    last_message_text = msg;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void skyrim_console::execute (std::string const& message)
+{
+    skyrim_log::print ("%s >> 0.00", message.c_str ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::uint32_t skyrim_console::selected_form ()
+{
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void setup_hooks ()
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,68 @@
+/**
+ * @file platform_windows.cpp
+ * @brief Windows implementation of platform.hpp, except the game hooks
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "console.hpp"
+#include "platform.hpp"
+#include <utils/imgui.hpp>
+#include <utils/winutils.hpp>
+
+//--------------------------------------------------------------------------------------------------
+
+static VOID CALLBACK
+timer_callback (HWND hwnd, UINT message, UINT_PTR idTimer, DWORD dwTime)
+{
+    execute_queued_command ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+platform::update_timer (int period)
+{
+    /// Current HWND, used for timer management
+    static HWND top_window = (HWND) imgui.igGetMainViewport ()->PlatformHandle;
+
+    if (period <= 0)
+        ::KillTimer (top_window, (UINT_PTR) timer_callback);
+
+    else if (!::SetTimer (top_window, (UINT_PTR) timer_callback, UINT (period), timer_callback))
+    {
+        log () << "Failed to create timer: "
+            << format_utf8message (::GetLastError ()) << std::endl;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+platform::create_process (std::string const& command_line, std::string const& output_file)
+{
+    return ::create_process (command_line, output_file);
+}
+
+//--------------------------------------------------------------------------------------------------
+
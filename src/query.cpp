@@ -0,0 +1,321 @@
+/**
+ * @file query.cpp
+ * @brief Boolean queries of substrings and patterns, as typed in the filters
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "query.hpp"
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------------------
+
+/// Length of the "re:" or "glob:" start, if any
+
+static std::size_t
+mode_length (std::string_view text, text_pattern::syntax_type& syntax)
+{
+    auto starts = [text] (std::string_view mode)
+    {
+        return text.size () >= mode.size () && std::equal (mode.begin (), mode.end (),
+                text.begin (), [] (char a, char b) { return a == fold_ascii (b); });
+    };
+    if (starts ("re:"))
+        return syntax = text_pattern::regex, 3;
+    if (starts ("glob:"))
+        return syntax = text_pattern::glob, 5;
+    return 0;
+}
+
+static std::string
+folded_string (std::string_view s)
+{
+    std::string r (s);
+    for (char& c: r)
+        c = fold_ascii (c);
+    return r;
+}
+
+static std::string
+upper_string (std::string_view s)
+{
+    std::string r (s);
+    for (char& c: r)
+        c = c >= 'a' && c <= 'z' ? char (c - ('a' - 'A')) : c;
+    return r;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * The key holds the parts as typed, but with the substrings upper cased (as the filters always
+ * did) and with the operators spelled one way, so that it differs only if the meaning differs.
+ * The left out parts are not in it, so that typing "-" after a query does not change it.
+ */
+
+text_query::text_query (std::string_view text)
+{
+    bool joined = false, negated = false;
+    std::size_t i = 0, n = text.size ();
+    while (true)
+    {
+        while (i < n && text[i] == ' ')
+            ++i;
+        if (i >= n)
+            break;
+        auto word = text.substr (i, std::min (text.find (' ', i), n) - i);
+
+        if (word == "OR" || word == "|" || word == "AND" || word == "NOT")
+        {
+            if (word == "NOT")
+                negated = !negated;
+            else
+                joined = word != "AND";
+            i += word.size ();
+            continue;
+        }
+
+        term t { {}, text_search (std::string_view ()), {}, text_pattern::regex, 0, negated };
+        negated = false;
+        if (text[i] == '-')
+            t.negated = !t.negated, ++i;
+        std::string part = t.negated ? "-" : "";
+        if (text.substr (i).starts_with ("in:"))
+            t.direction = -1, i += 3, part += "in:";
+        else if (text.substr (i).starts_with ("out:"))
+            t.direction = 1, i += 4, part += "out:";
+
+        // The term, up to a space or in quotes, with the closing one optional
+        auto quoted = [&text, &i, &n, &part] (bool fold)
+        {
+            std::string_view body;
+            if (i < n && text[i] == '"')
+            {
+                auto e = text.find ('"', i + 1);
+                body = text.substr (i + 1, std::min (e, n) - i - 1);
+                i = e == text.npos ? n : e + 1;
+                part += '"';
+                part += fold ? upper_string (body) : std::string (body);
+                if (e != text.npos)
+                    part += '"';
+            }
+            else
+            {
+                body = text.substr (i, std::min (text.find (' ', i), n) - i);
+                i += body.size ();
+                part += fold ? upper_string (body) : std::string (body);
+            }
+            return body;
+        };
+
+        text_pattern::syntax_type syntax;
+        if (auto m = mode_length (text.substr (i), syntax))
+        {
+            part += syntax == text_pattern::regex ? "re:" : "glob:";
+            i += m;
+            auto body = quoted (false);
+            if (!body.empty ())
+            {
+                t.text = body;
+                t.syntax = syntax;
+                t.pattern.emplace ();
+                if (auto e = t.pattern->compile (body, syntax); !e.empty () && problem.empty ())
+                    problem = std::move (e);
+            }
+        }
+        else
+        {
+            t.text = folded_string (quoted (true));
+            t.search = text_search (t.text);
+        }
+
+        // Unfinished, while a direction alone selects the records
+        if (t.text.empty () && !t.direction)
+            continue;
+
+        if (joined && !clauses.empty ())
+        {
+            canonical += " | ";
+            clauses.back ().push_back (std::move (t));
+        }
+        else
+        {
+            if (!canonical.empty ())
+                canonical += ' ';
+            clauses.emplace_back ().push_back (std::move (t));
+        }
+        canonical += part;
+        joined = false;
+    }
+
+    // The cheapest and the most selective first: the directions only, then the single substrings
+    // and patterns by the length of their literals, then the rest in the order as typed
+    auto rank = [] (std::vector<term> const& c)
+    {
+        if (std::all_of (c.begin (), c.end (), [] (term const& t) { return t.text.empty (); }))
+            return std::make_pair (0, std::size_t (0));
+        if (c.size () != 1 || c[0].negated)
+            return std::make_pair (2, std::size_t (0));
+        auto const& t = c[0];
+        return std::make_pair (1, ~(t.pattern ? t.pattern->literal () : t.text).size ());
+    };
+    std::stable_sort (clauses.begin (), clauses.end (), [&rank] (auto const& a, auto const& b) {
+        return rank (a) < rank (b);
+    });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<bool Folded>
+bool
+text_query::term::holds (const char* first, const char* last, int record_direction,
+        const char*& found) const
+{
+    bool r = !direction || direction == record_direction;
+    if (r && pattern)
+        r = Folded ? pattern->matches_folded (first, last) : pattern->matches (first, last);
+    else if (r && !text.empty ())
+    {
+        found = Folded ? search.find_folded (first, last) : search.find (first, last);
+        r = found != last;
+    }
+    return r != negated;
+}
+
+/// The span is of the first clause held by a found substring, the most selective one by the rank
+
+template<bool Folded>
+bool
+text_query::run (const char* first, const char* last, int direction, match_span* span) const
+{
+    for (auto const& c: clauses)
+    {
+        const char* found = nullptr;
+        auto t = std::find_if (c.begin (), c.end (), [&] (term const& t) {
+            found = nullptr;
+            return t.holds<Folded> (first, last, direction, found);
+        });
+        if (t == c.end ())
+            return false;
+        if (span && !span->length && !t->negated && !t->pattern && found && found != last
+                && std::size_t (found - first) + t->text.size () <= 0xffff)
+        {
+            span->offset = std::uint16_t (found - first);
+            span->length = std::uint16_t (t->text.size ());
+        }
+    }
+    return true;
+}
+
+bool
+text_query::contains (const char* first, const char* last, int direction) const
+{
+    return run<false> (first, last, direction, nullptr);
+}
+
+bool
+text_query::contains_folded (const char* first, const char* last, int direction) const
+{
+    return run<true> (first, last, direction, nullptr);
+}
+
+bool
+text_query::contains (const char* first, const char* last, int direction,
+        match_span& span) const
+{
+    span = {};
+    return run<false> (first, last, direction, &span);
+}
+
+bool
+text_query::contains_folded (const char* first, const char* last, int direction,
+        match_span& span) const
+{
+    span = {};
+    return run<true> (first, last, direction, &span);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Not holding a term implies not holding any other term which implies it
+
+bool
+text_query::term::implies (term const& other) const
+{
+    if (negated != other.negated)
+        return false;
+    auto const& a = negated ? other : *this;
+    auto const& b = negated ? *this : other;
+    if (b.direction && b.direction != a.direction)
+        return false;
+    if (!b.pattern && b.text.empty ())
+        return true;
+    if (a.pattern || b.pattern)
+        return a.pattern && b.pattern && a.syntax == b.syntax && a.text == b.text;
+    return a.text.find (b.text) != std::string::npos;
+}
+
+/// Each clause of the other one follows out of some of these clauses, as all of its terms imply
+/// any of the other clause terms
+
+bool
+text_query::implies (text_query const& other) const
+{
+    return std::all_of (other.clauses.begin (), other.clauses.end (), [this] (auto const& oc) {
+        return std::any_of (clauses.begin (), clauses.end (), [&oc] (auto const& c) {
+            return std::all_of (c.begin (), c.end (), [&oc] (term const& t) {
+                return std::any_of (oc.begin (), oc.end (), [&t] (term const& o) {
+                    return t.implies (o);
+                });
+            });
+        });
+    });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::string_view
+text_query::literal () const
+{
+    std::string_view r;
+    for (auto const& c: clauses)
+        if (c.size () == 1 && !c[0].negated)
+        {
+            std::string_view s = c[0].pattern ? c[0].pattern->literal () : c[0].text;
+            if (s.size () > r.size ())
+                r = s;
+        }
+    return r;
+}
+
+std::string_view
+text_query::word () const
+{
+    if (clauses.size () != 1 || clauses[0].size () != 1)
+        return {};
+    auto const& t = clauses[0][0];
+    return t.negated || t.pattern || t.direction ? std::string_view () : t.text;
+}
+
+//--------------------------------------------------------------------------------------------------
+
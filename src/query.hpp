@@ -0,0 +1,141 @@
+/**
+ * @file query.hpp
+ * @brief Boolean queries of substrings and patterns, as typed in the filters
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * The terms separated by spaces must all match, unless joined by "OR" (or "|") which binds
+ * tighter, e.g. "additem player OR npc" is additem and either player or npc. A term after "NOT"
+ * or starting with "-" must not match. A term is a substring, a "quoted phrase" with spaces, or
+ * a "re:" or "glob:" #text_pattern. With "in:" or "out:" in front, the term matches only the
+ * incoming or outgoing records, while "in:" or "out:" alone matches all of them (also written as
+ * "dir:in" and "dir:out" in the log filter, see #log_query).
+ *
+ * The query is compiled to clauses which all must hold, each having terms of which any must
+ * hold. The clauses are checked from the cheapest and the most selective ones, as estimated by
+ * the direction only terms and by the literal lengths, and the first failing one rejects the
+ * record. An unfinished term, e.g. "-" or an empty phrase, is left out, so that typing a query
+ * does not blink the result.
+ *
+ * While matching, the query can also tell where the first held substring is, out of the most
+ * selective clause having one, so that it can be highlighted without searching the record again.
+ * The patterns are not told apart this way, as their DFA knows only where a match ends.
+ */
+
+#ifndef SSE_CONSOLE_QUERY_HPP
+#define SSE_CONSOLE_QUERY_HPP
+
+#include "search.hpp"
+#include "pattern.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------------------
+
+/// Part of a record which holds a query, e.g. to highlight, empty if none or past 64 KiB
+struct match_span
+{
+    std::uint16_t offset = 0;
+    std::uint16_t length = 0;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+class text_query
+{
+public:
+
+    explicit text_query (std::string_view text);
+
+    /// Whether the record text holds, the direction being positive for outgoing records,
+    /// negative for incoming ones, or zero if the record has none
+    bool contains (const char* first, const char* last, int direction) const;
+
+    /// Same as #contains(), but faster for text with the ASCII letters already folded
+    bool contains_folded (const char* first, const char* last, int direction) const;
+
+    /// Same as #contains(), also setting where the record holds the query, if it does
+    bool contains (const char* first, const char* last, int direction, match_span& span) const;
+
+    /// Same as #contains_folded(), also setting where the record holds the query, if it does
+    bool contains_folded (const char* first, const char* last, int direction,
+            match_span& span) const;
+
+    /// Matches only records which the other query matches too, e.g. "playe" implies "pla"
+    bool implies (text_query const& other) const;
+
+    /// The query as typed, but the same for the texts which mean the same, e.g. differing only
+    /// in the letter case of the substrings
+    std::string const& key () const {
+        return canonical;
+    }
+
+    /// Also for an empty text
+    bool matches_all () const {
+        return clauses.empty ();
+    }
+
+    /// Which any match holds, e.g. to look up in an index, maybe empty
+    std::string_view literal () const;
+
+    /// The folded substring if the query is just that one, e.g. to match fuzzily, otherwise empty
+    std::string_view word () const;
+
+    /// Empty if usable, otherwise what is wrong with the query
+    std::string const& error () const {
+        return problem;
+    }
+
+private:
+
+    struct term
+    {
+        std::string text;               ///< Folded substring, or the pattern as typed
+        text_search search;
+        std::optional<text_pattern> pattern;
+        text_pattern::syntax_type syntax;
+        int direction;                  ///< Of the records, if not zero
+        bool negated;
+
+        /// Sets where the substring is, if it was searched for and found
+        template<bool Folded>
+        bool holds (const char* first, const char* last, int record_direction,
+                const char*& found) const;
+
+        bool implies (term const& other) const;
+    };
+
+    std::vector<std::vector<term>> clauses; ///< All must hold, by any of their terms
+    std::string canonical;
+    std::string problem;
+
+    template<bool Folded>
+    bool run (const char* first, const char* last, int direction, match_span* span) const;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_QUERY_HPP
+
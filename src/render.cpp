@@ -25,60 +25,95 @@
  * @details
  */
 
-#include "console.hpp"
+#include "render.hpp"
+#include "platform.hpp"
 #include <utils/misc.hpp>
 #include <utils/winutils.hpp>
+#include <gsl/gsl_util>
 #include <string_view>
+#include <algorithm>
+#include <cfloat>
 
 //--------------------------------------------------------------------------------------------------
 
-static std::vector<char> input_text_buffer;
-
-static int current_history;
+style_t style;
 
-static records_filter<log_index> log_filter;
-static records_filter<help_index> sse_filter, gui_filter, alias_filter;
+static std::vector<char> input_text_buffer;
 
 static render_load_files render_load_log;
 static render_load_files render_load_run;
 
-static bool scroll_to_bottom;
+static bool show_all_help;
 static bool show_sse_help;
 static bool show_gui_help;
 static bool show_alias_help;
 static bool show_settings;
 static bool show_save_log;
-static bool log_to_clipboard;
 static ImVec2 button_size;  ///< Public to keep consistency across windows
 
-/// Current HWND, used for timer management
-static HWND top_window = nullptr;
+static records_view<log_index> log_view;
+static records_view<help_index> all_view, sse_view, gui_view, alias_view;
 
-static void execute_command (std::string cmd);
+//--------------------------------------------------------------------------------------------------
+
+/// Bugged function in mainstream
+/// @see https://github.com/ocornut/imgui/issues/3454
+
+void
+ImGuiInputTextCallbackData_DeleteChars (ImGuiInputTextCallbackData* self, int pos, int bytes_count)
+{
+    Expects (pos + bytes_count <= self->BufTextLen);
+    char* dst = self->Buf + pos;
+    const char* src = self->Buf + pos + bytes_count;
+    while (char c = *src++)
+        *dst++ = c;
+    *dst = '\0';
+
+    if (self->CursorPos >= pos + bytes_count)
+        self->CursorPos -= bytes_count;
+    else if (self->CursorPos >= pos)
+        self->CursorPos = pos;
+    self->SelectionStart = self->SelectionEnd = self->CursorPos;
+    self->BufDirty = true;
+    self->BufTextLen -= bytes_count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+setup ()
+{
+    imgui.ImGuiInputTextCallbackData_DeleteChars = ImGuiInputTextCallbackData_DeleteChars;
+
+    if (!load_settings ())
+        return false;
+
+    if (!setup_render ())
+        return false;
+
+    if (!load_help_files ())
+        return false;
+
+    load_log_file (plugin_directory () + "default.log");
+    return true;
+}
 
 //--------------------------------------------------------------------------------------------------
 
 bool
 setup_render ()
 {
-    top_window = (HWND) imgui.igGetMainViewport ()->PlatformHandle;
+    setup_console ();
     input_text_buffer.clear ();
     input_text_buffer.resize (1024, '\0');
-    current_history = 0;
-    log_filter.init (&console.log_data, &console.log_indexes, { 3, 4, 6 });
-    sse_filter.init (&console.sse_data, &console.sse_indexes, { 3, 4, 6 });
-    gui_filter.init (&console.gui_data, &console.gui_indexes, { 3, 4, 6 });
-    alias_filter.init (&console.alias_data, &console.alias_indexes, { 3, 4, 6 });
     render_load_log.init ("SSE Console: Load", {".log"});
     render_load_run.init ("SSE Console: Run", {".log", ".txt"});
     show_settings = false;
     show_save_log = false;
     button_size = ImVec2 {0, 0};
-    log_to_clipboard = false;
     show_sse_help = false;
     show_gui_help = false;
     show_alias_help = false;
-    scroll_to_bottom = false;
     return true;
 }
 
@@ -92,52 +127,17 @@ input_text_callback (ImGuiInputTextCallbackData* data)
 
     case ImGuiInputTextFlags_CallbackCompletion:
     {
-        static std::vector<const char*> matches;
-        static std::hash<std::string_view> hash;
-        static std::size_t prev_uid = hash (std::string_view ("", 0));
-        static int prev_start = 0, prev_len = 0;
+        static text_completion completion;
 
-        auto update_text = [&] (int start, int len, const char* newval)
+        int start, count;
+        if (auto s = completion.complete (
+                    std::string_view (data->Buf, data->BufTextLen), data->CursorPos, start, count))
         {
-            imgui.ImGuiInputTextCallbackData_DeleteChars (data, start, len);
-            imgui.ImGuiInputTextCallbackData_InsertChars (data, data->CursorPos, newval, nullptr);
+            imgui.ImGuiInputTextCallbackData_DeleteChars (data, start, count);
+            imgui.ImGuiInputTextCallbackData_InsertChars (data, data->CursorPos, s, nullptr);
             imgui.ImGuiInputTextCallbackData_InsertChars (data, data->CursorPos, " ", nullptr);
-            prev_start = start, prev_len = std::strlen (newval) + 1;
-            prev_uid = hash (std::string_view (data->Buf, data->BufTextLen));
-        };
-
-        // Allows scrolling through different matches
-        auto curr_uid = hash (std::string_view (data->Buf, data->BufTextLen));
-        if (prev_uid == curr_uid && matches.size () > 1)
-        {
-            std::rotate (matches.begin (), matches.begin () + 1, matches.end ());
-            update_text (prev_start, prev_len, matches.front ());
-            return 0;
+            completion.completed (std::string_view (data->Buf, data->BufTextLen));
         }
-
-        // Find the start & end of the word
-        const char* word_end = data->Buf + data->CursorPos;
-        const char* word_begin = word_end;
-        for (; word_end < data->Buf + data->BufTextLen; ++word_end)
-            if (*word_end == ' ')
-                break;
-        for (; word_begin > data->Buf; --word_begin)
-            if (word_begin[-1] == ' ')
-                break;
-
-        // Small non-zero text is ignored as autocompletion - no reason
-        matches.clear ();
-        auto uprefix = uppercase_string (std::string (word_begin, word_end));
-        if (uprefix.size () < 2)
-            return 0;
-
-        // Find matches
-        for (auto i = console.completers.cbegin (); i != console.completers.cend (); ++i)
-            if (uppercase_string (*i).rfind (uprefix, 0) == 0)
-                matches.push_back (i->c_str ()); // Not expecting the completers to change at all
-
-        if (!matches.empty ())
-            update_text (int (word_begin - data->Buf), int (uprefix.size ()), matches.front ());
     }
         break;
 
@@ -147,20 +147,19 @@ input_text_callback (ImGuiInputTextCallbackData* data)
         if (console.log_indexes.empty ())
             return 0;
 
-        const char* left = nullptr;
         const char* mid = nullptr;
         const char* right = nullptr;
         static std::string prev_story;
 
         auto navigate = [&] (int step)
         {
-            int i = current_history;
+            int i = console.current_history;
             int n = console.log_indexes.size () - 1;
             i = std::clamp (i+step, 0, n);
             for (; i >= 0 && i <= n; i += step)
                 if (console.log_indexes[i].out)
                 {
-                    std::tie (left, mid, right) = extract_message (
+                    std::tie (mid, right) = extract_message (
                             console.log_data, console.log_indexes[i]);
 
                     // Ignore equal adjacent pairs
@@ -168,16 +167,17 @@ input_text_callback (ImGuiInputTextCallbackData* data)
                             || !std::equal (mid, right, prev_story.cbegin ()))
                     {
                         prev_story.assign (mid, right);
-                        current_history = i;
+                        console.current_history = i;
                         return;
                     }
                 }
             // Stick to the current valid choice, if nothing earlier/later was found
-            if (current_history >= 0 && current_history < int (console.log_indexes.size ())
-                    && console.log_indexes[current_history].out)
+            if (console.current_history >= 0
+                    && console.current_history < int (console.log_indexes.size ())
+                    && console.log_indexes[console.current_history].out)
             {
-                std::tie (left, mid, right) = extract_message (
-                        console.log_data, console.log_indexes[current_history]);
+                std::tie (mid, right) = extract_message (
+                        console.log_data, console.log_indexes[console.current_history]);
             }
         };
 
@@ -235,23 +235,26 @@ render_settings ()
 {
     if (imgui.igBegin ("SSE Console: Settings", &show_settings, 0))
     {
-        render_font_settings (console.gui_font, false);
+        render_font_settings (style.gui_font, false);
 
         imgui.igText ("");
-        render_font_settings (console.log_font, false);
+        render_font_settings (style.log_font, false);
 
         imgui.igText ("");
         imgui.igText ("Log colors:");
-        render_color_setting ("Prompt##Log color", console.prompt_color);
-        render_color_setting ("Commands##Log color", console.out_color);
-        render_color_setting ("Feedback##Log color", console.in_color);
+        render_color_setting ("Prompt##Log color", style.prompt_color);
+        render_color_setting ("Commands##Log color", style.out_color);
+        render_color_setting ("Feedback##Log color", style.in_color);
 
         imgui.igText ("");
         imgui.igText ("Help colors:");
-        render_color_setting ("Names##Help color", console.help_names_color);
-        render_color_setting ("Parameters##Help color", console.help_params_color);
-        render_color_setting ("Brief text##Help color", console.help_brief_color);
-        render_color_setting ("Details##Help color", console.help_details_color);
+        render_color_setting ("Names##Help color", style.help_names_color);
+        render_color_setting ("Parameters##Help color", style.help_params_color);
+        render_color_setting ("Brief text##Help color", style.help_brief_color);
+        render_color_setting ("Details##Help color", style.help_details_color);
+
+        imgui.igText ("");
+        render_color_setting ("Filter matches##Match color", style.match_color);
 
         imgui.igText ("");
         imgui.igText ("Running scripts:");
@@ -259,10 +262,39 @@ render_settings ()
                 std::max (50, USER_TIMER_MINIMUM), std::min (60'000, USER_TIMER_MAXIMUM),
                 "%d milliseconds", 0))
         {
-            extern void update_timer (int period);
             if (!console.commands.empty ())
-                update_timer (console.execution_delay);
+                platform::update_timer (console.execution_delay);
+        }
+
+        imgui.igText ("");
+        imgui.igText ("Log limits:");
+        int records = int (std::min<std::size_t> (console.log_max_records, 10'000'000));
+        if (imgui.igDragInt ("Records", &records, 100.f, 0, 10'000'000,
+                    records ? "%d records" : "Unlimited", ImGuiSliderFlags_AlwaysClamp))
+        {
+            console.log_max_records = std::size_t (records);
+            evict_log_records ();
+        }
+        int megabytes = int (console.log_max_bytes >> 20);
+        if (imgui.igDragInt ("Memory", &megabytes, 1.f, 0, int (max_log_bytes >> 20),
+                    megabytes ? "%d MiB" : "Unlimited", ImGuiSliderFlags_AlwaysClamp))
+        {
+            console.log_max_bytes = clamp_log_bytes (std::size_t (megabytes) << 20);
+            evict_log_records ();
+        }
+        imgui.igCheckbox ("Archive the evicted records", &console.log_archive);
+
+        imgui.igText ("");
+        imgui.igText ("Filtering:");
+        if (imgui.igCheckbox ("Folded copies of the text (faster, more memory)",
+                    &console.fold_copies))
+        {
+            fold_log_copy ();
+            fold_help_copies ();
         }
+        if (imgui.igCheckbox ("Index of the log text (faster, much more memory)",
+                    &console.index_log))
+            index_log_trigrams ();
 
         imgui.igText ("");
         if (imgui.igButton ("Save", button_size))
@@ -276,8 +308,81 @@ render_settings ()
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Fills behind the part of the span which falls in the text about to be drawn at the cursor. The
+ * lines are broken the same way ImGui does it when wrapping up to the content region end, so that
+ * only the lines holding the span get measured, out of the visible records only.
+ *
+ * @param record is where the span offsets are from
+ * @param first of the text to draw, within the @p record
+ * @param last of the text to draw
+ * @param wrapped if the text is drawn within igPushTextWrapPos (0)
+ */
+
+static void
+highlight_match (const char* record, match_span span, const char* first, const char* last,
+        bool wrapped)
+{
+    auto b = std::max (first, record + span.offset);
+    auto e = std::min (last, record + span.offset + span.length);
+    if (!span.length || b >= e)
+        return;
+
+    ImVec2 pos, avail;
+    imgui.igGetCursorScreenPos (&pos);
+    imgui.igGetContentRegionAvail (&avail);
+    auto* font = imgui.igGetFont ();
+    float size = imgui.igGetFontSize ();
+    float wrap = std::max (1.f, avail.x);
+    auto width = [font, size] (const char* s, const char* t)
+    {
+        ImVec2 v;
+        imgui.ImFont_CalcTextSizeA (&v, font, size, FLT_MAX, 0.f, s, t, nullptr);
+        return v.x;
+    };
+
+    auto* list = imgui.igGetWindowDrawList ();
+    for (auto s = first; s < e; pos.y += size)
+    {
+        auto eol = std::find (s, last, '\n');
+        if (wrapped && s != eol)
+            eol = std::max (s + 1, imgui.ImFont_CalcWordWrapPositionA (
+                        font, size / font->FontSize, s, eol, wrap));
+        if (b < eol && e > s)
+            imgui.ImDrawList_AddRectFilled (list,
+                    ImVec2 { pos.x + width (s, std::max (s, b)), pos.y },
+                    ImVec2 { pos.x + width (s, std::min (eol, e)), pos.y + size },
+                    style.match_color, 0.f, 0);
+        // The line break, or the blanks where wrapped, are not drawn
+        s = eol;
+        if (s < last && *s == '\n')
+            ++s;
+        else while (s < last && (*s == ' ' || *s == '\t'))
+            ++s;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// The parts of a help record, wherever it is from
+
+static auto
+help_text (records_filter<help_index> const& filter, help_index ndx)
+{
+    return extract_message (*filter.source_data (), ndx);
+}
+
+static auto
+help_text (help_search const& search, help_index ndx)
+{
+    return extract_message (search.source_data (ndx), ndx);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template<class Filter>
 static void
-render_help (const char* title, bool* show, records_filter<help_index>& filter)
+render_help (const char* title, bool* show, Filter& filter, records_view<help_index>& view)
 {
     if (imgui.igBegin (title, show, 0))
     {
@@ -292,36 +397,68 @@ render_help (const char* title, bool* show, records_filter<help_index>& filter)
         }
 
         imgui.igBeginChild_Str ("##Help", ImVec2 {0, 0}, false, 0);
-        // See #render_log() for why this chews FPS
-        auto const* display_records = filter.current_indexes ();
-        for (std::size_t i = 0, n = display_records->size (); i < n; ++i)
+
+        // Only the visible records are submitted, see #records_view
+        auto measure = [&filter] (help_index ndx, float width)
         {
-            auto [names, params, brief, details, end] =
-                extract_message (*filter.source_data (), (*display_records)[i]);
+            auto [names, params, brief, details, end] = help_text (filter, ndx);
+
+            float spacing = imgui.igGetStyle ()->ItemSpacing.y;
+            float h = imgui.igGetFontSize (); // The empty line
+            ImVec2 size;
+            imgui.igCalcTextSize (&size, names, params, false, -1.f);
+            h += spacing + size.y;
+            if (params != brief)
+            {
+                imgui.igCalcTextSize (&size, params, brief, false, -1.f);
+                h += spacing + size.y;
+            }
+            if (brief != details)
+            {
+                imgui.igCalcTextSize (&size, brief, details, false, width);
+                h += spacing + size.y;
+            }
+            if (details != end)
+            {
+                imgui.igCalcTextSize (&size, details, end, false, width);
+                h += spacing + size.y;
+            }
+            return h;
+        };
+
+        auto draw = [&filter] (help_index ndx, match_span span)
+        {
+            auto [names, params, brief, details, end] = help_text (filter, ndx);
 
             imgui.igText ("");
             int pops = 0;
-            imgui.igPushStyleColor_U32 (ImGuiCol_Text, console.help_names_color); ++pops;
+            imgui.igPushStyleColor_U32 (ImGuiCol_Text, style.help_names_color); ++pops;
+            highlight_match (names, span, names, params, false);
             imgui.igTextUnformatted (names, params);
             if (params != brief)
             {
-                imgui.igPushStyleColor_U32 (ImGuiCol_Text, console.help_params_color); ++pops;
+                imgui.igPushStyleColor_U32 (ImGuiCol_Text, style.help_params_color); ++pops;
+                highlight_match (names, span, params, brief, false);
                 imgui.igTextUnformatted (params, brief);
             }
             imgui.igPushTextWrapPos (0.f);
             if (brief != details)
             {
-                imgui.igPushStyleColor_U32 (ImGuiCol_Text, console.help_brief_color); ++pops;
+                imgui.igPushStyleColor_U32 (ImGuiCol_Text, style.help_brief_color); ++pops;
+                highlight_match (names, span, brief, details, true);
                 imgui.igTextUnformatted (brief, details);
             }
             if (details != end)
             {
-                imgui.igPushStyleColor_U32 (ImGuiCol_Text, console.help_details_color); ++pops;
+                imgui.igPushStyleColor_U32 (ImGuiCol_Text, style.help_details_color); ++pops;
+                highlight_match (names, span, details, end, true);
                 imgui.igTextUnformatted (details, end);
             }
             imgui.igPopStyleColor (pops);
             imgui.igPopTextWrapPos ();
-        }
+        };
+
+        view.render (filter, measure, draw);
         imgui.igEndChild ();
     }
     imgui.igEnd ();
@@ -333,306 +470,87 @@ static void
 render_log ()
 {
     float footer_height = 3 * imgui.igGetFrameHeightWithSpacing ();
-    imgui.igPushFont (console.log_font.imfont);
+    imgui.igPushFont (style.log_font.imfont);
     imgui.igBeginChild_Str ("##Log", ImVec2 { 0, -footer_height }, false, 0);
 
-    if (log_to_clipboard)
-        imgui.igLogToClipboard (-1);
-
-    // TODO: The ImGuiListClipper works only for evenly spaced items or the igSetScrollHereY
-    // down will botch on each multiline record, making everything to look awkward. Hence, to
-    // get proper position a full blown rendering is done, which botches the FPS in turn. For
-    // 10k records here, it drains near 6 fps. To circumvent this a custom clipping must be
-    // done, which likely will involve pre-computing the height of each item as function of the
-    // text font, scale, word wrapping due to widget size/resize, number of newlines in the
-    // record and item spacing. Another likely solution is to find which change and expose of the
-    // ImGui internals will sove the problem during the SetScrollHereY. Usage of the log file
-    // saving/loading features are suggested to workaround the fps loss.
-    auto const* display_records = log_filter.current_indexes ();
-    for (std::size_t i = 0, n = display_records->size (); i < n; ++i)
-    {
-        auto ndx = (*display_records)[i];
-        auto [left, mid, right] = extract_message (console.log_data, ndx);
-
-        imgui.igPushStyleColor_U32 (ImGuiCol_Text, console.prompt_color);
-        imgui.igTextUnformatted (left, mid);
-        imgui.igPopStyleColor (1);
-
-        imgui.igSameLine (0, -1);
-        imgui.igPushTextWrapPos (0.f);
-        imgui.igPushStyleColor_U32 (ImGuiCol_Text, ndx.out ? console.out_color:console.in_color);
-        imgui.igTextUnformatted (mid, right);
-        imgui.igPopStyleColor (1);
-        imgui.igPopTextWrapPos ();
-    }
-
-    if (log_to_clipboard)
-    {
-        log_to_clipboard = false;
-        imgui.igLogFinish ();
-    }
-
-    if (scroll_to_bottom)
-    {
-        scroll_to_bottom = false;
-        imgui.igSetScrollHereY (1.f);
-    }
-
-    imgui.igEndChild ();
-    imgui.igPopFont ();
-}
-
-//--------------------------------------------------------------------------------------------------
-
-static void
-execute_command (std::string cmd)
-{
-    trim_both (cmd, ' ');
-    if (cmd.empty ())
-        return;
-
-    record_log_message (true, cmd);
-
-    std::string result;
-    if (cmd[0] == '/')
-    {
-        extern void update_timer (int);
-
-        std::string param;
-        auto match_param = [&cmd, &param] (std::string_view txt)
-        {
-            if (txt.size () <= cmd.size () && cmd.rfind (txt, 0) == 0)
-            {
-                param = trim_begin (cmd.substr (txt.size ()), ' ');
-                return true;
-            }
-            return false;
-        };
-
-        if (match_param ("/run "))
-        {
-            if (load_run_file (plugin_directory () + param) && !console.commands.empty ())
-                update_timer (console.execution_delay);
-            else result = "Unable to run script file.";
-        }
-        else if (cmd == "/run-enough")
-        {
-            console.commands.clear ();
-            update_timer (0);
-        }
-        else if (cmd == "/copy")
-            log_to_clipboard = true;
-        else if (cmd == "/clear")
-        {
-            log_filter.reset ();
-            console.log_data.clear ();
-            console.log_indexes.clear ();
-            console.counter_in = console.counter_out = 0;
-            current_history = 0;
-        }
-        else if (match_param ("/load "))
-        {
-            if (load_log_file (plugin_directory () + param + ".log"))
-            {
-                current_history = 0;
-                log_filter.reset ();
-            }
-            else result = "Unable to load log file.";
-        }
-        else if (match_param ("/save "))
-            save_log_file (plugin_directory () + param + ".log");
-
-        else if (match_param ("/async "))
-        {
-            std::error_code ec;
-            std::filesystem::remove (plugin_directory () + "async", ec);
-            if (!create_process (param, plugin_directory () + "async"))
-                result = "Unable to create a process.";
-        }
-        else if (cmd == "/async-read")
-        {
-            std::ifstream fi (plugin_directory () + "async");
-            if (fi.is_open ())
-            {
-                std::stringstream ss;
-                ss << fi.rdbuf ();
-                result = ss.str ();
-            }
-            else result = "Unable to read file.";
-        }
-
-        else if (match_param ("/filter-alias") && param.size ()+1 < alias_filter.buffer.size ())
-            *std::copy (param.cbegin (), param.cend (), alias_filter.buffer.begin ()) = '\0';
-        else if (match_param ("/filter-sse") && param.size ()+1 < sse_filter.buffer.size ())
-            *std::copy (param.cbegin (), param.cend (), sse_filter.buffer.begin ()) = '\0';
-        else if (match_param ("/filter-gui") && param.size ()+1 < gui_filter.buffer.size ())
-            *std::copy (param.cbegin (), param.cend (), gui_filter.buffer.begin ()) = '\0';
-        else if (match_param ("/filter") && param.size ()+1 < log_filter.buffer.size ())
-            *std::copy (param.cbegin (), param.cend (), log_filter.buffer.begin ()) = '\0';
-
-        else if (match_param ("/alias-delete ") && param.size () > 1)
-        {
-            param = '.' + param;
-            auto old_size = console.completers.size ();
-            for (std::size_t i = 0, ni = console.alias_indexes.size (); i < ni; ++i)
-            {
-                auto [n, p, b, d, e] =
-                    extract_message (console.alias_data, console.alias_indexes[i]);
-
-                std::string name (n, p);
-                if (param == name)
-                {
-                    console.alias_data.erase (
-                            console.alias_data.begin () + (n - &console.alias_data[0]),
-                            console.alias_data.begin () + (e - &console.alias_data[0]));
-                    console.alias_indexes.erase (console.alias_indexes.begin () + i);
-                    for (ni -= 1; i < ni; ++i)
-                        console.alias_indexes[i].begin -= e - n;
-                    alias_filter.reset ();
-                    alias_filter.update (alias_filter.buffer.data (), true);
-
-                    console.completers.erase (std::remove (
-                                console.completers.begin (), console.completers.end (), name),
-                            console.completers.end ());
-
-                    save_aliases ();
-                    break;
-                }
-            }
-            if (old_size == console.completers.size ())
-                result = "Unable to delete an alias.";
-        }
-        else if (match_param ("/alias "))
-        {
-            auto old_size = console.completers.size ();
-            if (auto i = param.find (' '); i != std::string::npos && i+1 < param.size ())
-            {
-                auto n = '.' + param.substr (0, i);
-                auto b = trim_both (param.substr (i), ' ');
-                if (b.size () && std::find (
-                            console.completers.cbegin (), console.completers.cend (), n)
-                        == console.completers.cend ())
-                {
-                    help_index ndx;
-                    ndx.begin = console.alias_data.size ();
-                    std::string p;
-                    for (std::size_t i = 0, n = b.size (); i < n; ++i)
-                        if (auto j = b.find ('<', i); j != std::string::npos)
-                            if (auto k = b.find ('>', j+1); k != std::string::npos)
-                                p += b.substr (j, k-j+1) + " ", i = k;
-                    trim_end (p, ' ');
-                    ndx.params = n.size ();
-                    ndx.brief = p.size ();
-                    ndx.details = b.size ();
-                    ndx.end = 0;
-
-                    console.alias_data.insert (console.alias_data.end (), n.cbegin (), n.cend ());
-                    console.alias_data.insert (console.alias_data.end (), p.cbegin (), p.cend ());
-                    console.alias_data.insert (console.alias_data.end (), b.cbegin (), b.cend ());
-                    console.alias_indexes.push_back (ndx);
-                    console.completers.push_back (n);
-
-                    alias_filter.reset ();
-                    alias_filter.update (alias_filter.buffer.data (), true);
-                    save_aliases ();
-                }
-            }
-            if (old_size == console.completers.size ())
-                result = "Unable to create an alias.";
-        }
-        else result = "Unknown GUI command.";
+    console.log_filter.poll ();
+    auto const* display_records = console.log_filter.current_indexes ();
 
-        cmd.clear ();
-    }
-    else if (cmd[0] == '.' && cmd.size () > 1)
+    if (console.log_to_clipboard)
     {
-        auto actuals = split (cmd, ' ');
-        std::string brief, params;
-
-        for (auto const& ndx: console.alias_indexes)
-            if (auto [n, p, b, d, e] = extract_message (console.alias_data, ndx);
-                    actuals[0] == std::string_view (n, p-n))
-            {
-                params.assign (p, b);
-                brief.assign (b, d);
-                break;
-            }
-
-        if (params.size ())
+        console.log_to_clipboard = false;
+        std::string text;
+        char prompt[prompt_capacity];
+        for (auto ndx: *display_records)
         {
-            std::reverse (actuals.begin (), actuals.end ());
-            actuals.pop_back ();
-
-            if (actuals.size () != split (params, ' ').size ())
-                brief.clear ();
-            else
-            {
-                for (std::size_t i = 0; i < brief.size () && actuals.size (); ++i)
-                    if (auto j = brief.find ('<', i); j != std::string::npos)
-                        if (auto k = brief.find ('>', j+1); k != std::string::npos)
-                        {
-                            brief.replace (j, k-j+1, actuals.back ());
-                            i = j + actuals.back ().size ();
-                            actuals.pop_back ();
-                        }
-            }
+            auto [b, e] = extract_message (console.log_data, ndx);
+            text.append (format_prompt (ndx, prompt)).append (b, e).push_back ('\n');
         }
-
-        if (brief.size ())
-            cmd = brief;
-        else result = "Unable to execute an alias.";
+        imgui.igSetClipboardText (text.c_str ());
     }
 
-    if (result.size ())
+    // Only the visible records are submitted, see #records_view
+    auto measure = [] (log_index ndx, float width)
     {
-        record_log_message (false, result);
-        result.clear ();
-        cmd.clear ();
-    }
-
-    if (cmd.size ())
-    {
-        skyrim_log::last_message ("");
-        skyrim_console::execute (cmd);
-        result = skyrim_log::last_message ();
-        if (result.size ())
-            record_log_message (false, result);
-    }
-
-    current_history = console.log_indexes.size ();
-    log_filter.update (log_filter.buffer.data (), true);
-    scroll_to_bottom = true;
-}
+        char buffer[prompt_capacity];
+        auto left = format_prompt (ndx, buffer);
+        auto [mid, right] = extract_message (console.log_data, ndx);
+        ImVec2 prompt, message;
+        imgui.igCalcTextSize (&prompt, left.data (), left.data () + left.size (), false, -1.f);
+        imgui.igCalcTextSize (&message, mid, right, false,
+                std::max (1.f, width - prompt.x - imgui.igGetStyle ()->ItemSpacing.x));
+        return std::max (prompt.y, message.y);
+    };
 
-//--------------------------------------------------------------------------------------------------
+    // Not filtered, hence the found record only shows where it holds the query
+    auto found = console.log_find ? console.log_finder.found () : console.log_finder.npos;
+    auto found_begin = found == console.log_finder.npos
+        ? std::uint32_t (-1) : console.log_indexes[found].begin;
 
-static VOID CALLBACK
-timer_callback (HWND hwnd, UINT message, UINT_PTR idTimer, DWORD dwTime)
-{
-    if (console.commands.empty ())
+    auto draw = [found_begin] (log_index ndx, match_span span)
     {
-        extern void update_timer (int);
-        update_timer (0);
-        return;
-    }
+        if (ndx.begin == found_begin)
+            span = console.log_finder.found_span ();
 
-    execute_command (std::move (console.commands.back ()));
-    console.commands.pop_back ();
-}
+        char buffer[prompt_capacity];
+        auto left = format_prompt (ndx, buffer);
+        auto [mid, right] = extract_message (console.log_data, ndx);
 
-//--------------------------------------------------------------------------------------------------
+        imgui.igPushStyleColor_U32 (ImGuiCol_Text, style.prompt_color);
+        imgui.igTextUnformatted (left.data (), left.data () + left.size ());
+        imgui.igPopStyleColor (1);
 
-void
-update_timer (int period)
-{
-    if (period <= 0)
-        ::KillTimer (top_window, (UINT_PTR) timer_callback);
+        imgui.igSameLine (0, -1);
+        imgui.igPushTextWrapPos (0.f);
+        imgui.igPushStyleColor_U32 (ImGuiCol_Text, ndx.out ? style.out_color:style.in_color);
+        highlight_match (mid, span, mid, right, true);
+        imgui.igTextUnformatted (mid, right);
+        imgui.igPopStyleColor (1);
+        imgui.igPopTextWrapPos ();
+    };
 
-    else if (!::SetTimer (top_window, (UINT_PTR) timer_callback, UINT (period), timer_callback))
+    if (console.scroll_to_found && found != console.log_finder.npos)
+        log_view.scroll_to (found);
+    log_view.render (console.log_filter, measure, draw,
+            console.scroll_to_bottom && !console.scroll_to_found);
+    console.scroll_to_bottom = console.scroll_to_found = false;
+
+    // Over the previous result, in the top right corner
+    if (console.log_filter.pending ())
     {
-        log () << "Failed to create timer: "
-            << format_utf8message (::GetLastError ()) << std::endl;
+        const char* text = "Filtering...";
+        ImVec2 pos, size;
+        imgui.igGetWindowPos (&pos);
+        imgui.igCalcTextSize (&size, text, nullptr, false, -1.f);
+        auto const* s = imgui.igGetStyle ();
+        pos.x += imgui.igGetWindowWidth () - size.x - s->WindowPadding.x - s->ScrollbarSize;
+        pos.y += s->WindowPadding.y;
+        imgui.ImDrawList_AddText_Vec2 (imgui.igGetWindowDrawList (), pos,
+                imgui.igGetColorU32_Col (ImGuiCol_TextDisabled, 1.f), text, nullptr);
     }
+
+    imgui.igEndChild ();
+    imgui.igPopFont ();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -645,7 +563,7 @@ void render (int active)
         return;
 
     default_theme theme_on;
-    imgui.igPushFont (console.gui_font.imfont);
+    imgui.igPushFont (style.gui_font.imfont);
 
     imgui.igSetNextWindowSize (ImVec2 { 800, 600 }, ImGuiCond_FirstUseEver);
     if (imgui.igBegin ("SSE Console", nullptr, ImGuiWindowFlags_HorizontalScrollbar))
@@ -709,6 +627,11 @@ void render (int active)
         imgui.igButton ("Help", button_size);
         if (imgui.igBeginPopupContextItem ("##Help popup", 0))
         {
+            if (imgui.igButton ("All##Help popup", button_size))
+            {
+                show_all_help = true;
+                imgui.igCloseCurrentPopup ();
+            }
             if (imgui.igButton ("Skyrim##Help popup", button_size))
             {
                 show_sse_help = true;
@@ -727,16 +650,35 @@ void render (int active)
             imgui.igEndPopup ();
         }
 
+        // Either filters the log, or finds in all of it, Enter going to the older match and
+        // Shift+Enter to the newer one
         imgui.igSameLine (0, -1);
-        imgui.igTextUnformatted (" Filter:", nullptr);
+        if (imgui.igSmallButton (console.log_find ? "Find:##Log" : "Filter:##Log"))
+        {
+            console.log_find = !console.log_find;
+            update_log_filter ();
+            if (console.log_find)
+                find_log_record (true);
+        }
+        if (imgui.igIsItemHovered (0))
+            imgui.igSetTooltip ("Switch between filtering and finding");
 
         imgui.igSameLine (0, -1);
         imgui.igSetNextItemWidth (-1);
-        if (imgui.igInputText ("##Filter",
-                    log_filter.buffer.data (), int (log_filter.buffer.size ()),
-                    0, &filter_text_callback, nullptr))
+        bool entered = imgui.igInputText ("##Filter",
+                console.log_filter.buffer.data (), int (console.log_filter.buffer.size ()),
+                console.log_find ? ImGuiInputTextFlags_EnterReturnsTrue : 0,
+                &filter_text_callback, nullptr);
+        if (console.log_find ? imgui.igIsItemEdited () : entered)
         {
-            log_filter.update (log_filter.buffer.data ());
+            update_log_filter ();
+            if (console.log_find && console.log_finder.found () == console.log_finder.npos)
+                find_log_record (true);
+        }
+        if (console.log_find && entered)
+        {
+            find_log_record (!imgui.igGetIO ()->KeyShift);
+            imgui.igSetKeyboardFocusHere (-1);
         }
 
         // New line
@@ -757,12 +699,15 @@ void render (int active)
         render_save_log ();
     if (show_settings)
         render_settings ();
+    if (show_all_help)
+        render_help ("SSE Console: All help", &show_all_help, console.all_help, all_view);
     if (show_sse_help)
-        render_help ("SSE Console: Skyrim commands", &show_sse_help, sse_filter);
+        render_help ("SSE Console: Skyrim commands", &show_sse_help, console.sse_filter, sse_view);
     if (show_gui_help)
-        render_help ("SSE Console: GUI commands", &show_gui_help, gui_filter);
+        render_help ("SSE Console: GUI commands", &show_gui_help, console.gui_filter, gui_view);
     if (show_alias_help)
-        render_help ("SSE Console: Aliases", &show_alias_help, alias_filter);
+        render_help ("SSE Console: Aliases", &show_alias_help, console.alias_filter,
+                alias_view);
 
     imgui.igPopFont ();
 }
@@ -0,0 +1,303 @@
+/**
+ * @file render.hpp
+ * @brief Shared interface between the GUI files in SSE-Console
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup GUI
+ *
+ * @details
+ */
+
+#ifndef SSE_CONSOLE_RENDER_HPP
+#define SSE_CONSOLE_RENDER_HPP
+
+#include "console.hpp"
+#include <utils/imgui.hpp>
+#include <chrono>
+
+//--------------------------------------------------------------------------------------------------
+
+struct style_t
+{
+    font_t gui_font, log_font;
+    std::uint32_t prompt_color, out_color, in_color;
+    std::uint32_t help_names_color, help_params_color, help_brief_color, help_details_color;
+    std::uint32_t match_color;      ///< Behind the filter matches
+};
+
+extern style_t style;
+
+bool load_settings ();
+bool save_settings ();
+
+bool setup ();
+bool setup_render ();
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Clipped rendering of variable height records, so only the visible ones get submitted.
+ *
+ * ImGuiListClipper wants evenly spaced items, but the records wrap and span few lines. Hence, the
+ * height of each record is cached per source record, as function of the font, its size and the
+ * available width, while the running sum over the displayed records gives their positions. The
+ * caller supplies how to measure a record's height (without the item spacing) and how to draw it,
+ * given also where it holds the filter query, as recorded by the filter.
+ *
+ * Changing the font or the width (e.g. resizing the window) does not re-measure everything at
+ * once. The old heights stay as estimates, the visible records are re-measured right away, while
+ * the rest are refined in the following frames, within a time budget, starting around the
+ * visible ones. Records never measured are estimated as one line of text.
+ *
+ * Scrolling to a given record takes its position out of the running sum, right away if all of the
+ * source records are shown, so that e.g. jumping between the found records costs no layout.
+ */
+
+template<class IndexT>
+class records_view
+{
+public:
+
+    /// How much of each frame can go in refining the heights of the records out of sight
+    static constexpr auto frame_budget = std::chrono::microseconds (1500);
+
+    /// On the next #render(), scrolls to the record at that position in the source, if shown
+    void scroll_to (std::size_t position)
+    {
+        target = position;
+    }
+
+    /// Of a #records_filter, or of anything with the same indexes and revisions, e.g. #help_search
+    template<class Filter, class Measure, class Draw>
+    void render (Filter const& filter,
+            Measure&& measure, Draw&& draw, bool scroll_to_bottom = false)
+    {
+        ImVec2 avail;
+        imgui.igGetContentRegionAvail (&avail);
+        layout_key k { imgui.igGetFont (), imgui.igGetFontSize (), avail.x,
+            imgui.igGetStyle ()->ItemSpacing.y };
+
+        auto const* source = filter.source_indexes ();
+        auto const* shown = filter.current_indexes ();
+
+        if (filter.source_revision () != source_revision)
+        {
+            source_revision = filter.source_revision ();
+            heights.clear ();
+            epochs.clear ();
+            offsets.clear ();
+        }
+
+        // Evicted records are gone from the front of the source, along with their heights
+        auto evicted = std::min (filter.dropped () - dropped, heights.size ());
+        dropped = filter.dropped ();
+        heights.erase (heights.begin (), heights.begin () + evicted);
+        epochs.erase (epochs.begin (), epochs.begin () + evicted);
+
+        if (!(k == key))
+        {
+            bool relayout = k.spacing != key.spacing || k.size != key.size;
+            key = k;
+            if (++epoch == 0) // Wrapped around, let all be stale for sure
+                std::fill (epochs.begin (), epochs.end (), epoch++);
+            fresh_low = fresh_high = 0;
+            if (relayout) // Just so the estimates are more useful on font change
+                offsets.clear ();
+        }
+        heights.resize (source->size (), -1.f);
+        epochs.resize (source->size (), 0);
+
+        float top = imgui.igGetCursorPosY ();
+        float scroll = imgui.igGetScrollY ();
+        float visible = imgui.igGetWindowHeight ();
+
+        // Appended records to an unchanged view are laid out after the old ones. Otherwise,
+        // the top visible record, or the one after it, is kept in place (e.g. on filter change).
+        std::uint32_t anchor = -1;
+        float anchor_shift = 0;
+        if (filter.revision () != revision || shown != displayed || offsets.empty ()
+                || offsets.size () > shown->size () + 1)
+        {
+            if (!rows.empty () && !offsets.empty ())
+            {
+                auto i = row_at (scroll - top);
+                anchor = rows[i] >= evicted ? rows[i] - evicted : 0;
+                anchor_shift = rows[i] >= evicted ? scroll - top - offsets[i] : 0;
+            }
+            revision = filter.revision ();
+            displayed = shown;
+            offsets.assign (1, 0.f);
+            rows.clear ();
+            fresh_low = fresh_high = 0;
+        }
+        for (std::size_t i = rows.size (), n = shown->size (); i < n; ++i)
+        {
+            rows.push_back (source_position (*source, *shown, i));
+            offsets.push_back (offsets.back () + height (rows.back ()) + key.spacing);
+        }
+
+        if (shown->empty ())
+            return;
+
+        if (anchor != std::uint32_t (-1))
+        {
+            auto i = std::lower_bound (rows.cbegin (), rows.cend (), anchor) - rows.cbegin ();
+            if (std::size_t (i) < rows.size ())
+                scroll = std::max (0.f, top + offsets[i] + (rows[i] == anchor ? anchor_shift : 0));
+            else
+                scroll = std::max (0.f, top + offsets.back () - visible);
+        }
+
+        // A third down the window, with no search if the rows are the source positions
+        if (target != std::size_t (-1))
+        {
+            auto i = shown == source ? target : std::size_t (
+                    std::lower_bound (rows.cbegin (), rows.cend (), target) - rows.cbegin ());
+            if (i < rows.size () && rows[i] == target)
+                scroll = std::max (0.f, top + offsets[i] - visible / 3);
+            target = -1;
+        }
+
+        // The heights of the visible records must be exact, which may move the visible window
+        std::size_t first, last;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            if (scroll_to_bottom)
+                scroll = std::max (0.f, top + offsets.back () - visible);
+            first = row_at (scroll - top);
+            last = std::min (rows.size (), row_at (scroll - top + visible) + 1);
+
+            std::size_t changed = rows.size ();
+            for (auto i = first; i < last; ++i)
+                if (refine (rows[i], (*shown)[i], measure))
+                    changed = std::min (changed, i);
+            if (changed == rows.size ())
+                break;
+            scroll += update_offsets (changed, first);
+        }
+
+        if (scroll_to_bottom)
+            imgui.igSetScrollFromPosY_Float (top + offsets.back () - imgui.igGetScrollY (), 1.f);
+        else if (scroll != imgui.igGetScrollY ())
+            imgui.igSetScrollY_Float (scroll);
+
+        imgui.igSetCursorPosY (top + offsets[first]);
+        for (auto i = first; i < last; ++i)
+            draw ((*shown)[i], filter.highlight (i));
+        imgui.igSetCursorPosY (top + offsets.back () - key.spacing);
+
+        // Whatever time is left, refine outwards of the visible window
+        if (fresh_high < first || fresh_low > last || fresh_low == fresh_high)
+            fresh_low = first, fresh_high = last;
+        else
+            fresh_low = std::min (fresh_low, first), fresh_high = std::max (fresh_high, last);
+
+        auto deadline = std::chrono::steady_clock::now () + frame_budget;
+        std::size_t changed = rows.size ();
+        for (unsigned n = 0; fresh_low > 0 || fresh_high < rows.size (); ++n)
+        {
+            if (auto i = fresh_high; i < rows.size () && refine (rows[i], (*shown)[i], measure))
+                changed = std::min (changed, i);
+            fresh_high = std::min (rows.size (), fresh_high + 1);
+            if (auto i = fresh_low-1; fresh_low > 0 && refine (rows[i], (*shown)[i], measure))
+                changed = std::min (changed, i);
+            fresh_low -= fresh_low > 0;
+            if (n % 64 == 63 && std::chrono::steady_clock::now () > deadline)
+                break;
+        }
+        if (changed < rows.size ())
+            if (float delta = update_offsets (changed, first); delta != 0)
+                imgui.igSetScrollY_Float (scroll + delta);
+    }
+
+private:
+
+    struct layout_key
+    {
+        ImFont* font = nullptr;
+        float size = 0, width = 0, spacing = 0;
+        bool operator == (layout_key const& o) const {
+            return font == o.font && size == o.size && width == o.width && spacing == o.spacing;
+        }
+    };
+
+    layout_key key;
+    std::uint16_t epoch = 0;        ///< Heights measured with the current #key
+    std::size_t source_revision = -1;
+    std::size_t revision = -1;
+    std::size_t dropped = 0;
+    std::vector<IndexT> const* displayed = nullptr;
+    std::size_t target = -1;        ///< Source position of the record to scroll to, once
+
+    std::vector<float> heights;         ///< Per source record, negative if never measured
+    std::vector<std::uint16_t> epochs;  ///< Per source record, stale if not the current #epoch
+    std::vector<std::uint32_t> rows;    ///< Position in the source of each displayed record
+    std::vector<float> offsets;         ///< Top of each displayed record, followed by the end
+    std::size_t fresh_low = 0;          ///< Displayed records in [low, high) are not stale
+    std::size_t fresh_high = 0;
+
+    float height (std::size_t j) const {
+        return heights[j] < 0 ? key.size : heights[j];
+    }
+
+    /// True if the height changed
+    template<class Measure>
+    bool refine (std::size_t j, IndexT ndx, Measure& measure)
+    {
+        if (epochs[j] == epoch)
+            return false;
+        epochs[j] = epoch;
+        float h = measure (ndx, key.width);
+        return std::exchange (heights[j], h) != h;
+    }
+
+    /// Redo the running sum from the given row, returning how much the anchor row moved
+    float update_offsets (std::size_t from, std::size_t anchor)
+    {
+        float old = offsets[anchor];
+        for (auto i = from, n = rows.size (); i < n; ++i)
+            offsets[i+1] = offsets[i] + height (rows[i]) + key.spacing;
+        return offsets[anchor] - old;
+    }
+
+    /// Displayed records are always an ordered subset of the source ones
+    std::uint32_t source_position (
+            std::vector<IndexT> const& source, std::vector<IndexT> const& shown, std::size_t i)
+    {
+        if (&shown == &source)
+            return std::uint32_t (i);
+        std::size_t j = rows.empty () ? 0 : rows.back () + 1;
+        while (j < source.size () && source[j].begin != shown[i].begin)
+            ++j;
+        return std::uint32_t (std::min (j, source.size () - 1));
+    }
+
+    /// The displayed record at given distance from the top
+    std::size_t row_at (float y) const
+    {
+        auto i = std::upper_bound (offsets.cbegin (), offsets.cend (), y) - offsets.cbegin ();
+        return std::size_t (std::clamp<std::ptrdiff_t> (i - 1, 0, offsets.size () - 2));
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_RENDER_HPP
+
@@ -0,0 +1,222 @@
+/**
+ * @file search.cpp
+ * @brief Case-insensitive substring search, as used by the filters
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "search.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+typedef const char* (*find_function) (const char*, const char*, std::string const&);
+
+/// Each kernel is made twice: folding the text, or for text which is already folded
+template<bool Fold>
+static inline char
+fold_char (char c)
+{
+    return Fold ? fold_ascii (c) : c;
+}
+
+template<bool Fold>
+static bool
+equal_folded (const char* text, const char* needle, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        if (fold_char<Fold> (text[i]) != needle[i])
+            return false;
+    return true;
+}
+
+template<bool Fold>
+static const char*
+find_scalar (const char* first, const char* last, std::string const& needle)
+{
+    auto n = needle.size ();
+    if (std::size_t (last - first) < n)
+        return last;
+    for (auto p = first, end = last - n + 1; p < end; ++p)
+        if (fold_char<Fold> (*p) == needle[0]
+                && equal_folded<Fold> (p + 1, needle.data () + 1, n - 1))
+            return p;
+    return last;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+#if SEARCH_X86
+
+// Only 'A' to 'Z' get below -102 as signed bytes, when shifted so that 'A' is at -128
+
+template<bool Fold>
+__attribute__((target("sse2"))) static inline __m128i
+fold_sse2 (__m128i x)
+{
+    if (!Fold)
+        return x;
+    auto t = _mm_add_epi8 (x, _mm_set1_epi8 (char (128 - 'A')));
+    auto upper = _mm_cmpgt_epi8 (_mm_set1_epi8 (-128 + 26), t);
+    return _mm_or_si128 (x, _mm_and_si128 (upper, _mm_set1_epi8 (0x20)));
+}
+
+template<bool Fold>
+__attribute__((target("avx2"))) static inline __m256i
+fold_avx2 (__m256i x)
+{
+    if (!Fold)
+        return x;
+    auto t = _mm256_add_epi8 (x, _mm256_set1_epi8 (char (128 - 'A')));
+    auto upper = _mm256_cmpgt_epi8 (_mm256_set1_epi8 (-128 + 26), t);
+    return _mm256_or_si256 (x, _mm256_and_si256 (upper, _mm256_set1_epi8 (0x20)));
+}
+
+/**
+ * Blocks where both the first and the last needle characters match, verifying the middle. The
+ * last block overlaps the previous one, ignoring the candidates already checked, so that there
+ * is no scalar tail. Texts shorter than a block go to the narrower kernel, before touching any
+ * wider register, or there would be a penalty for mixing the AVX and SSE code.
+ */
+
+template<bool Fold>
+__attribute__((target("sse2"))) static const char*
+find_sse2 (const char* first, const char* last, std::string const& needle)
+{
+    std::size_t n = needle.size (), size = std::size_t (last - first);
+    if (size < n - 1 + 16)
+        return find_scalar<Fold> (first, last, needle);
+
+    auto front = _mm_set1_epi8 (needle.front ());
+    auto back = _mm_set1_epi8 (needle.back ());
+    auto middle = n < 2 ? 0 : n - 2;
+    auto end = size - (n - 1);
+
+    for (std::size_t i = 0; i < end; i += 16)
+    {
+        unsigned skip = 0;
+        if (i + 16 > end)
+            skip = unsigned (i + 16 - end), i = end - 16;
+
+        auto a = fold_sse2<Fold> (_mm_loadu_si128 ((__m128i const*) (first + i)));
+        auto b = fold_sse2<Fold> (_mm_loadu_si128 ((__m128i const*) (first + i + n - 1)));
+        unsigned mask = unsigned (_mm_movemask_epi8 (
+                    _mm_and_si128 (_mm_cmpeq_epi8 (a, front), _mm_cmpeq_epi8 (b, back))));
+        for (mask &= ~0u << skip; mask; mask &= mask - 1)
+        {
+            auto p = first + i + __builtin_ctz (mask);
+            if (equal_folded<Fold> (p + 1, needle.data () + 1, middle))
+                return p;
+        }
+    }
+    return last;
+}
+
+template<bool Fold>
+__attribute__((target("avx2"))) static const char*
+find_avx2 (const char* first, const char* last, std::string const& needle)
+{
+    std::size_t n = needle.size (), size = std::size_t (last - first);
+    if (size < n - 1 + 32)
+        return find_sse2<Fold> (first, last, needle);
+
+    auto front = _mm256_set1_epi8 (needle.front ());
+    auto back = _mm256_set1_epi8 (needle.back ());
+    auto middle = n < 2 ? 0 : n - 2;
+    auto end = size - (n - 1);
+
+    for (std::size_t i = 0; i < end; i += 32)
+    {
+        unsigned skip = 0;
+        if (i + 32 > end)
+            skip = unsigned (i + 32 - end), i = end - 32;
+
+        auto a = fold_avx2<Fold> (_mm256_loadu_si256 ((__m256i const*) (first + i)));
+        auto b = fold_avx2<Fold> (_mm256_loadu_si256 ((__m256i const*) (first + i + n - 1)));
+        unsigned mask = unsigned (_mm256_movemask_epi8 (_mm256_and_si256 (
+                        _mm256_cmpeq_epi8 (a, front), _mm256_cmpeq_epi8 (b, back))));
+        for (mask &= ~0u << skip; mask; mask &= mask - 1)
+        {
+            auto p = first + i + __builtin_ctz (mask);
+            if (equal_folded<Fold> (p + 1, needle.data () + 1, middle))
+                return p;
+        }
+    }
+    return last;
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------------
+
+template<bool Fold>
+static find_function
+best_find_function ()
+{
+#if SEARCH_X86
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+        return find_avx2<Fold>;
+    if (__builtin_cpu_supports ("sse2"))
+        return find_sse2<Fold>;
+#endif
+    return find_scalar<Fold>;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+text_search::text_search (std::string_view text)
+    : needle (text)
+{
+    for (char& c: needle)
+        c = fold_ascii (c);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const char*
+text_search::find (const char* first, const char* last) const
+{
+    static const find_function find_best = best_find_function<true> ();
+    if (needle.empty ())
+        return first;
+    return find_best (first, last, needle);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const char*
+text_search::find_folded (const char* first, const char* last) const
+{
+    static const find_function find_best = best_find_function<false> ();
+    if (needle.empty ())
+        return first;
+    return find_best (first, last, needle);
+}
+
+//--------------------------------------------------------------------------------------------------
+
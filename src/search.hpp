@@ -0,0 +1,82 @@
+/**
+ * @file search.hpp
+ * @brief Case-insensitive substring search, as used by the filters
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * Only the ASCII letters are folded, the rest of the bytes (e.g. UTF-8 sequences) must be equal.
+ * The text is scanned in place, comparing blocks of 32 (AVX2) or 16 (SSE2) bytes against the
+ * first and the last needle characters at once, so that only the few candidates get verified.
+ * The instruction set is picked once, on the first use, wrt to what the CPU supports.
+ */
+
+#ifndef SSE_CONSOLE_SEARCH_HPP
+#define SSE_CONSOLE_SEARCH_HPP
+
+#include <string>
+#include <string_view>
+
+//--------------------------------------------------------------------------------------------------
+
+constexpr char
+fold_ascii (char c)
+{
+    return c >= 'A' && c <= 'Z' ? char (c + ('a' - 'A')) : c;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Prepared once per needle, then applied without allocations on any number of texts
+
+class text_search
+{
+public:
+
+    explicit text_search (std::string_view needle);
+
+    /// The first match in [first, last), or last if none. An empty needle matches at first.
+    const char* find (const char* first, const char* last) const;
+
+    bool contains (const char* first, const char* last) const {
+        return needle.empty () || find (first, last) != last;
+    }
+
+    /// Same as #find(), but faster for text with the ASCII letters already folded
+    const char* find_folded (const char* first, const char* last) const;
+
+    bool contains_folded (const char* first, const char* last) const {
+        return needle.empty () || find_folded (first, last) != last;
+    }
+
+    std::size_t size () const {
+        return needle.size ();
+    }
+
+private:
+
+    std::string needle; ///< Folded
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_SEARCH_HPP
+
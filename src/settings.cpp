@@ -0,0 +1,164 @@
+/**
+ * @file settings.cpp
+ * @brief Loading and saving of the GUI look and the general behaviour
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup GUI
+ *
+ * @details
+ */
+
+#include "render.hpp"
+#include <utils/winutils.hpp>
+
+static const std::filesystem::path location = plugin_directory () + "settings.json";
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+save_settings ()
+{
+    try
+    {
+        nlohmann::json json = {
+            { "Log colors", {
+                { "prompt", hex_string (style.prompt_color) },
+                { "out", hex_string (style.out_color) },
+                { "in", hex_string (style.in_color) },
+            }},
+            { "Help colors", {
+                { "names", hex_string (style.help_names_color) },
+                { "params", hex_string (style.help_params_color) },
+                { "brief", hex_string (style.help_brief_color) },
+                { "details", hex_string (style.help_details_color) },
+            }},
+            { "Match color", hex_string (style.match_color) },
+            { "Execution delay", console.execution_delay },
+            { "Log limits", {
+                { "records", console.log_max_records },
+                { "bytes", console.log_max_bytes },
+                { "archive", console.log_archive },
+            }},
+            { "Folded copies", console.fold_copies },
+            { "Log index", console.index_log }
+        };
+
+        save_font (json, style.gui_font);
+        save_font (json, style.log_font);
+        save_json (json, location);
+    }
+    catch (std::exception const& ex)
+    {
+        log () << "Unable to save settings file: " << ex.what () << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+load_settings ()
+{
+    try
+    {
+        auto json = load_json (location);
+
+        style.gui_font.name = "Default";
+        style.gui_font.scale = 1.f;
+        style.gui_font.size = 32.f;
+        style.gui_font.color = IM_COL32_WHITE;
+        style.gui_font.file = "";
+        style.gui_font.default_data = font_inconsolata;
+        load_font (json, style.gui_font);
+
+        style.log_font.name = "Log";
+        style.log_font.scale = 1.f;
+        style.log_font.size = 32.f;
+        style.log_font.color = IM_COL32_WHITE;
+        style.log_font.file = "";
+        style.log_font.default_data = font_inconsolata;
+        load_font (json, style.log_font);
+
+        style.prompt_color = IM_COL32 (0, 192, 0, 255);
+        style.out_color = IM_COL32 (255, 255, 255, 255);
+        style.in_color = IM_COL32 (192, 192, 192, 255);
+        if (json.contains ("Log colors"))
+        {
+            auto const& j = json["Log colors"];
+            style.prompt_color = std::stoul (
+                    j.value ("prompt", hex_string (style.prompt_color)), nullptr, 0);
+            style.out_color = std::stoul (
+                    j.value ("out", hex_string (style.out_color)), nullptr, 0);
+            style.in_color = std::stoul (
+                    j.value ("in", hex_string (style.in_color)), nullptr, 0);
+        }
+
+        style.help_names_color = IM_COL32 (255, 255, 255, 255);
+        style.help_params_color = IM_COL32 (128, 128, 128, 255);
+        style.help_brief_color = IM_COL32 (192, 192, 192, 255);
+        style.help_details_color = IM_COL32 (128, 128, 128, 255);
+        if (json.contains ("Help colors"))
+        {
+            auto const& j = json["Help colors"];
+            style.help_names_color = std::stoul (
+                    j.value ("names", hex_string (style.help_names_color)), nullptr, 0);
+            style.help_params_color = std::stoul (
+                    j.value ("params", hex_string (style.help_params_color)), nullptr, 0);
+            style.help_brief_color = std::stoul (
+                    j.value ("brief", hex_string (style.help_brief_color)), nullptr, 0);
+            style.help_details_color = std::stoul (
+                    j.value ("details", hex_string (style.help_details_color)), nullptr, 0);
+        }
+
+        style.match_color = std::stoul (json.value ("Match color",
+                    hex_string (IM_COL32 (96, 96, 0, 255))), nullptr, 0);
+
+        console.execution_delay = json.value ("Execution delay", 100);
+
+        console.log_max_records = 0;
+        console.log_max_bytes = 0;
+        console.log_archive = false;
+        if (json.contains ("Log limits"))
+        {
+            auto const& j = json["Log limits"];
+            console.log_max_records = j.value ("records", console.log_max_records);
+            console.log_max_bytes = clamp_log_bytes (j.value ("bytes", console.log_max_bytes));
+            console.log_archive = j.value ("archive", console.log_archive);
+        }
+        evict_log_records ();
+
+        console.fold_copies = json.value ("Folded copies", false);
+        fold_log_copy ();
+        fold_help_copies ();
+
+        console.index_log = json.value ("Log index", false);
+        index_log_trigrams ();
+    }
+    catch (std::exception const& ex)
+    {
+        log () << "Unable to load settings file: " << ex.what () << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,143 @@
+/**
+ * @file trigram.cpp
+ * @brief Inverted index of the text trigrams, for filtering large logs without a full scan
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "trigram.hpp"
+#include "search.hpp"
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------------------
+
+static inline std::uint32_t
+trigram (const char* p)
+{
+    return std::uint32_t (std::uint8_t (fold_ascii (p[0]))) << 16
+         | std::uint32_t (std::uint8_t (fold_ascii (p[1]))) << 8
+         | std::uint32_t (std::uint8_t (fold_ascii (p[2])));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+trigram_index::add (const char* first, const char* last)
+{
+    auto ordinal = next++;
+    for (auto p = first; last - p >= 3; ++p)
+    {
+        auto& list = postings[trigram (p)];
+        if (list.empty () || list.back () != ordinal)
+            list.push_back (ordinal);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Trimming only when there is more evicted than live, so that it is amortized over the drops
+
+void
+trigram_index::drop (std::size_t count)
+{
+    first = std::min (next, first + std::uint32_t (count));
+    if (first - trimmed <= next - first)
+        return;
+
+    for (auto i = postings.begin (); i != postings.end (); )
+    {
+        auto& list = i->second;
+        list.erase (list.begin (), std::lower_bound (list.begin (), list.end (), first));
+        if (list.empty ())
+            i = postings.erase (i);
+        else
+            ++i;
+    }
+    trimmed = first;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+trigram_index::clear ()
+{
+    postings.clear ();
+    next = first = trimmed = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool
+trigram_index::candidates (std::string_view needle, std::vector<std::uint32_t>& positions) const
+{
+    positions.clear ();
+    if (needle.size () < 3)
+        return false;
+
+    // The rarest trigrams first, as the result can be only smaller than them
+    std::vector<std::pair<std::uint32_t const*, std::uint32_t const*>> lists;
+    for (std::size_t i = 0; i + 3 <= needle.size (); ++i)
+    {
+        auto it = postings.find (trigram (needle.data () + i));
+        if (it == postings.end ())
+            return true;
+        auto const& list = it->second;
+        auto b = std::lower_bound (list.data (), list.data () + list.size (), first);
+        lists.emplace_back (b, list.data () + list.size ());
+    }
+    std::sort (lists.begin (), lists.end (), [] (auto const& a, auto const& b) {
+        return std::make_pair (a.second - a.first, a.first)
+             < std::make_pair (b.second - b.first, b.first);
+    });
+    lists.erase (std::unique (lists.begin (), lists.end ()), lists.end ());
+
+    positions.assign (lists[0].first, lists[0].second);
+    for (std::size_t i = 1; i < lists.size () && !positions.empty (); ++i)
+    {
+        auto [b, e] = lists[i];
+        positions.erase (std::remove_if (positions.begin (), positions.end (),
+                    [&b, e] (std::uint32_t ordinal) {
+                        b = std::lower_bound (b, e, ordinal);
+                        return b == e || *b != ordinal;
+                    }), positions.end ());
+    }
+    for (auto& p: positions)
+        p -= first;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t
+trigram_index::memory () const
+{
+    // Roughly the hash nodes and buckets, as the standard does not tell
+    std::size_t n = postings.bucket_count () * sizeof (void*)
+        + postings.size () * (sizeof (decltype (postings)::value_type) + 2 * sizeof (void*));
+    for (auto const& [key, list]: postings)
+        n += list.capacity () * sizeof (std::uint32_t);
+    return n;
+}
+
+//--------------------------------------------------------------------------------------------------
+
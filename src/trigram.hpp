@@ -0,0 +1,75 @@
+/**
+ * @file trigram.hpp
+ * @brief Inverted index of the text trigrams, for filtering large logs without a full scan
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * Each record gets an ordinal on #trigram_index::add(), one after another, and each (ASCII
+ * folded) trigram of its text lists the ordinals of the records having it. A needle of three or
+ * more characters can be only in the records found in the lists of all its trigrams, which then
+ * have to be verified as the trigrams may be in any order. Evicting the oldest records moves the
+ * first valid ordinal, while the lists are trimmed once in a while.
+ */
+
+#ifndef SSE_CONSOLE_TRIGRAM_HPP
+#define SSE_CONSOLE_TRIGRAM_HPP
+
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+
+//--------------------------------------------------------------------------------------------------
+
+class trigram_index
+{
+public:
+
+    /// The next record, in the same order as its source
+    void add (const char* first, const char* last);
+
+    /// The oldest records were removed from the source
+    void drop (std::size_t count);
+
+    void clear ();
+
+    /**
+     * Positions in the source (i.e. without the dropped records) of the records which may hold
+     * the needle, in order. False if the needle is too short to use the index at all.
+     */
+    bool candidates (std::string_view needle, std::vector<std::uint32_t>& positions) const;
+
+    /// Approximate bytes held
+    std::size_t memory () const;
+
+private:
+
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings;
+    std::uint32_t next = 0;     ///< Ordinal of the next record
+    std::uint32_t first = 0;    ///< Ordinal of the oldest record still in the source
+    std::uint32_t trimmed = 0;  ///< The lists have no ordinals before it
+};
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_TRIGRAM_HPP
+
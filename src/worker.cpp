@@ -0,0 +1,196 @@
+/**
+ * @file worker.cpp
+ * @brief Worker thread for the jobs which must not hold the game frame, e.g. filtering a large log
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ */
+
+#include "worker.hpp"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------------------
+
+/// The lock is held only to hand over a job, never while running one
+
+struct background_worker::shared_state
+{
+    std::mutex lock;
+    std::condition_variable wake;
+    std::function<void ()> job;
+    bool stop = false;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+background_worker::~background_worker ()
+{
+    if (!state)
+        return;
+    {
+        std::lock_guard<std::mutex> guard (state->lock);
+        state->stop = true;
+        state->job = nullptr;
+    }
+    state->wake.notify_one ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+background_worker::submit (std::function<void ()> job)
+{
+    if (!state)
+    {
+        state = std::make_shared<shared_state> ();
+        std::thread ([s = state] {
+            for (;;)
+            {
+                std::function<void ()> job;
+                {
+                    std::unique_lock<std::mutex> guard (s->lock);
+                    s->wake.wait (guard, [&s] { return s->stop || s->job; });
+                    if (s->stop)
+                        return;
+                    job.swap (s->job);
+                }
+                job ();
+            }
+        }).detach ();
+    }
+    {
+        std::lock_guard<std::mutex> guard (state->lock);
+        state->job = std::move (job);
+    }
+    state->wake.notify_one ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Parts are claimed one by one by whoever runs them, the last one done wakes up the caller
+
+struct parallel_batch
+{
+    std::function<void (std::size_t)> const* task;
+    std::size_t parts;
+    std::atomic<std::size_t> next = 0, done = 0;
+    std::mutex lock;
+    std::condition_variable finished;
+
+    /// False if there was no part left
+    bool run_next ()
+    {
+        auto i = next++;
+        if (i >= parts)
+            return false;
+        (*task) (i);
+        if (++done == parts)
+        {
+            std::lock_guard<std::mutex> guard (lock);
+            finished.notify_all ();
+        }
+        return true;
+    }
+};
+
+struct parallel_pool
+{
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<parallel_batch>> batches;
+    std::size_t threads;
+};
+
+/// Never destroyed, as the threads may be still waiting on it while the process exits
+static parallel_pool&
+shared_pool ()
+{
+    static parallel_pool* pool = []
+    {
+        auto p = new parallel_pool;
+        p->threads = std::clamp<std::size_t> (std::thread::hardware_concurrency (), 1, 16);
+        for (std::size_t i = 1; i < p->threads; ++i)
+            std::thread ([p] {
+                for (;;)
+                {
+                    std::shared_ptr<parallel_batch> b;
+                    {
+                        std::unique_lock<std::mutex> guard (p->lock);
+                        p->wake.wait (guard, [p] { return !p->batches.empty (); });
+                        b = p->batches.front ();
+                        if (b->next >= b->parts)
+                        {
+                            p->batches.pop_front ();
+                            continue;
+                        }
+                    }
+                    b->run_next ();
+                }
+            }).detach ();
+        return p;
+    } ();
+    return *pool;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::size_t
+parallel_threads ()
+{
+    return shared_pool ().threads;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+run_parallel (std::size_t parts, std::function<void (std::size_t)> const& task)
+{
+    auto& pool = shared_pool ();
+    if (parts < 2 || pool.threads < 2)
+    {
+        for (std::size_t i = 0; i < parts; ++i)
+            task (i);
+        return;
+    }
+
+    auto b = std::make_shared<parallel_batch> ();
+    b->task = &task;
+    b->parts = parts;
+    {
+        std::lock_guard<std::mutex> guard (pool.lock);
+        pool.batches.push_back (b);
+    }
+    pool.wake.notify_all ();
+
+    while (b->run_next ())
+        ;
+    std::unique_lock<std::mutex> guard (b->lock);
+    b->finished.wait (guard, [&b] { return b->done == b->parts; });
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,75 @@
+/**
+ * @file worker.hpp
+ * @brief Worker thread for the jobs which must not hold the game frame, e.g. filtering a large log
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Core
+ *
+ * @details
+ * The thread is started on the first job and runs one job at a time. A job submitted while
+ * another one waits replaces it, as only the latest one matters (e.g. for the latest filter text).
+ * Cancelling a running job and taking its result are up to the job itself, usually with atomics
+ * it shares with the submitter.
+ *
+ * Separately, #run_parallel() splits a job in parts over a pool of threads, one per core, started
+ * on its first use. The calling thread runs parts too, so the parts never wait for a free thread
+ * even if the pool is busy with other callers.
+ */
+
+#ifndef SSE_CONSOLE_WORKER_HPP
+#define SSE_CONSOLE_WORKER_HPP
+
+#include <functional>
+#include <memory>
+
+//--------------------------------------------------------------------------------------------------
+
+class background_worker
+{
+public:
+
+    background_worker () = default;
+    background_worker (background_worker const&) = delete;
+    background_worker& operator = (background_worker const&) = delete;
+
+    /// Does not wait for the running job, the thread ends on its own after it
+    ~background_worker ();
+
+    /// Replaces the job waiting to be run, if any
+    void submit (std::function<void ()> job);
+
+private:
+
+    struct shared_state;
+    std::shared_ptr<shared_state> state;    ///< Along with the thread, which may outlive this
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/// Threads the parts of #run_parallel() go on, the calling one included
+std::size_t parallel_threads ();
+
+/// Runs the task for each part, from 0 to parts-1, returning when all of them are done
+void run_parallel (std::size_t parts, std::function<void (std::size_t)> const& task);
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_WORKER_HPP
+
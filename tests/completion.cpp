@@ -0,0 +1,206 @@
+/**
+ * @file completion.cpp
+ * @brief Checks of the names pool used in the Tab completion
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include "fuzzy.hpp"
+#include <random>
+#include <fstream>
+#include <set>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (25);
+
+/// Short, so many of them share a prefix or differ only in the letter case
+static std::string
+random_name ()
+{
+    static const char letters[] = { 'a', 'A', 'b', 'B', '_', '.', '\xc3', '\xa9' };
+    std::string s (1 + rng () % 4, ' ');
+    for (auto& c: s)
+        c = letters[rng () % std::size (letters)];
+    return s;
+}
+
+static std::string
+folded (std::string_view s)
+{
+    std::string r (s);
+    std::transform (r.begin (), r.end (), r.begin (), fold_ascii);
+    return r;
+}
+
+/// The pool holds exactly these names, each with its mask, and finds them in any letter case
+
+static bool
+same_names (completion_names const& names, std::set<std::string> const& model)
+{
+    if (names.size () != model.size ())
+        return false;
+    std::set<std::string> found;
+    for (std::size_t i = 0; i < names.size (); ++i)
+    {
+        auto n = names.name (i);
+        if (!model.contains (std::string (n)) || std::strlen (names[i]) != n.size ()
+                || names.mask (i) != fuzzy_mask (n) || !names.contains (n))
+            return false;
+        // The same ones when folded are next to each other, as written
+        if (i > 0 && folded (names.name (i-1)) == folded (n) && !(names.name (i-1) < n))
+            return false;
+        found.emplace (n);
+    }
+    return found == model;
+}
+
+/// The range are all of the names starting with the prefix in any letter case, and only them
+
+static bool
+same_prefixed (completion_names const& names, std::string const& prefix)
+{
+    auto [first, last] = names.prefixed (prefix);
+    for (std::size_t i = 0; i < names.size (); ++i)
+        if ((first <= i && i < last) != folded (names.name (i)).starts_with (folded (prefix)))
+            return false;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+test_names ()
+{
+    std::vector<std::string> initial;
+    for (int i = 0; i < 200; ++i)
+        initial.push_back (random_name ());
+    initial.push_back ("");
+    initial.push_back (initial.front ());
+
+    completion_names names;
+    names.assign (initial);
+    std::set<std::string> model (initial.begin (), initial.end ());
+    model.erase ("");
+    CHECK (same_names (names, model));
+
+    for (int step = 0; step < 2000 && !failures_so_far (); ++step)
+    {
+        auto n = random_name ();
+        auto revision = names.revision ();
+        bool changed;
+        if (rng () % 2)
+        {
+            changed = names.insert (n);
+            CHECK (changed == model.emplace (n).second);
+        }
+        else
+        {
+            changed = names.erase (n);
+            CHECK (changed == (model.erase (n) > 0));
+        }
+        CHECK (changed == (names.revision () != revision));
+        CHECK (names.contains (n) == model.contains (n));
+        CHECK (same_prefixed (names, random_name ()));
+        if (step % 50 == 0)
+            CHECK (same_names (names, model));
+    }
+    CHECK (same_names (names, model));
+    CHECK (!names.insert ("") && !names.erase ("") && !names.contains (""));
+}
+
+/// Repeated presses cycle through the names in any letter case, until the names change
+
+static void
+test_cycle ()
+{
+    auto completers = console.completers;
+    console.completers.assign ({ "AddItem", "additemmenu", "ADDITEM", "Disable", "AddItem" });
+
+    text_completion tab;
+    auto press = [&tab] (std::string& line)
+    {
+        int start, count;
+        auto r = tab.complete (line, int (line.size ()), start, count);
+        if (!r)
+            return false;
+        line.replace (std::size_t (start), std::size_t (count), std::string (r) + ' ');
+        tab.completed (line);
+        return true;
+    };
+
+    std::string line = "player.additem aDDi";
+    std::vector<std::string> seen;
+    for (int i = 0; i < 4 && press (line); ++i)
+        seen.push_back (line);
+    CHECK (seen == (std::vector<std::string> { "player.additem ADDITEM ",
+                "player.additem AddItem ", "player.additem additemmenu ",
+                "player.additem ADDITEM " }));
+
+    // A new name ends the cycling, as if the line was typed
+    console.completers.insert ("addition");
+    CHECK (!press (line) && line == "player.additem ADDITEM ");
+    line = "dis";
+    CHECK (press (line) && line == "Disable ");
+
+    console.completers = completers;
+}
+
+/// The other names of a help record complete too, not only as displayed after a space
+
+static void
+test_help_names ()
+{
+    std::ofstream (plugin_directory () + "help_sse.json")
+        << R"([{ "names": ["AddItem", "ai"], "brief": "Adds an item." }])";
+    std::ofstream (plugin_directory () + "help_gui.json") << R"([{ "names": ["/filter"] }])";
+    CHECK (load_help_files ());
+
+    auto& names = console.completers;
+    CHECK (names.size () == 3 && names.contains ("ai") && !names.contains (" ai"));
+    CHECK (std::string (console.sse_data.begin (), console.sse_data.end ())
+            == "AddItem aiAdds an item.");
+
+    std::filesystem::remove (plugin_directory () + "help_sse.json");
+    std::filesystem::remove (plugin_directory () + "help_gui.json");
+    for (auto& d: { &console.sse_data, &console.gui_data, &console.alias_data })
+        d->clear ();
+    for (auto& i: { &console.sse_indexes, &console.gui_indexes, &console.alias_indexes })
+        i->clear ();
+    console.completers.assign ({});
+    fold_help_copies ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_completion ()
+{
+    test_names ();
+    test_cycle ();
+    test_help_names ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
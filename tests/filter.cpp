@@ -0,0 +1,442 @@
+/**
+ * @file filter.cpp
+ * @brief Checks of the log filter against matching each record on its own
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include <random>
+#include <thread>
+#include <chrono>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (7);
+
+static const char* words[] = {
+    "player.additem", "coc", "riverwood", "tgm", "getav", "health", "0000000f", "not found"
+};
+
+/// The counters of the records expected to be shown for the filter text
+static std::vector<std::uint32_t>
+naive (std::string const& filter_text)
+{
+    auto now = console.log_indexes.back ().time;
+    log_query scope;
+    text_query query (scope.parse (filter_text, now));
+    std::vector<std::uint32_t> r;
+    std::vector<log_index> selected;
+    for (auto const& i: console.log_indexes)
+    {
+        selected.clear ();
+        scope.select (&i, &i + 1, selected);
+        auto [b, e] = extract_message (console.log_data, i);
+        if (!selected.empty () && query.contains (b, e, record_direction (i)))
+            r.push_back (i.counter << 1 | i.out);
+    }
+    return r;
+}
+
+static std::vector<std::uint32_t>
+shown ()
+{
+    std::vector<std::uint32_t> r;
+    for (auto const& i: *console.log_filter.current_indexes ())
+        r.push_back (i.counter << 1 | i.out);
+    return r;
+}
+
+static void
+set_filter (std::string const& text)
+{
+    console.log_find = false;
+    *std::copy (text.begin (), text.end (), console.log_filter.buffer.begin ()) = '\0';
+    update_log_filter ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// A scope of a single record still needs the text to match
+
+static void
+test_single_scoped ()
+{
+    reset_log ();
+    for (int i = 0; i < 10; ++i)
+        record_log_message (true, "tgm");
+    set_filter ("counter:5 additem");
+    CHECK (shown ().empty ());
+    set_filter ("counter:5 tgm");
+    CHECK (shown ().size () == 1);
+    set_filter ("");
+
+    // Also for an empty log, and the records appended after
+    reset_log ();
+    set_filter ("additem");
+    record_log_message (true, "tgm");
+    record_log_message (true, "player.additem f 1");
+    set_filter ("additem");
+    CHECK (shown ().size () == 1);
+    set_filter ("");
+}
+
+/// Random queries of scopes and text, typed a character at a time
+
+static void
+test_random_queries ()
+{
+    reset_log ();
+    for (int i = 0; i < 300; ++i)
+    {
+        std::string msg;
+        for (int k = int (rng () % 3) + 1; k--; )
+            msg += std::string (words[rng () % std::size (words)]) + ' ';
+        record_log_message (rng () % 2, msg);
+    }
+
+    const char* scopes[] = { "", "dir:out ", "dir:in ", "counter:1 ", "counter:5..20 " };
+    const char* texts[] = { "", "additem", "coc", "health", "riverwood", "not found", "tgm" };
+    for (int n = 0; n < 200; ++n)
+    {
+        auto full = std::string (scopes[rng () % std::size (scopes)])
+            + scopes[rng () % std::size (scopes)] + texts[rng () % std::size (texts)];
+        for (std::size_t k = 1; k <= full.size (); ++k)
+        {
+            auto text = full.substr (0, k);
+            set_filter (text);
+
+            // Short text leaves all of the scope
+            auto rest = trimmed_both (log_query ().parse (text, console.log_indexes.back ().time),
+                    ' ');
+            if (rest.empty () || rest.size () >= 3)
+                CHECK (shown () == naive (text));
+        }
+    }
+    set_filter ("");
+}
+
+/// The "dir:" words are the same as the "in:" and "out:" terms, also when negated or joined
+
+static void
+test_direction_alias ()
+{
+    reset_log ();
+    for (int i = 0; i < 20; ++i)
+        record_log_message (i % 2, i % 3 ? "tgm" : "coc riverwood");
+
+    std::pair<const char*, const char*> same[] = {
+        { "dir:in", "in:" }, { "dir:out tgm", "out: tgm" }, { "-dir:out", "-out:" },
+        { "dir:in OR coc", "in: OR coc" }, { "NOT dir:in", "NOT in:" },
+        { "counter:3..9 dir:out", "counter:3..9 out:" }, { "\"dir:in\"", "\"dir:in\"" }
+    };
+    for (auto [alias, term]: same)
+    {
+        set_filter (term);
+        auto expected = shown ();
+        set_filter (alias);
+        CHECK (shown () == expected);
+        CHECK (shown () == naive (alias));
+    }
+
+    set_filter ("dir:in");
+    CHECK (shown ().size () == 10);
+    set_filter ("dir:in dir:out");
+    CHECK (shown ().empty ());
+    set_filter ("");
+}
+
+/// The times are mostly in order, but not after the clock was set back
+
+static void
+test_time_unordered ()
+{
+    reset_log ();
+    std::tm tm {};
+    tm.tm_year = 2024 - 1900;
+    tm.tm_mon = 2;
+    tm.tm_mday = 10;
+    tm.tm_hour = 12;
+    tm.tm_isdst = -1;
+    auto noon = std::uint32_t (std::mktime (&tm));
+    for (std::uint32_t i = 0; i < 40; ++i)
+    {
+        record_log_message (i % 2, "tgm");
+        console.log_indexes.back ().time = noon + (i < 30 ? i : i - 25) * 60;
+    }
+    for (auto text: { "time:2024-03-10T12:03..2024-03-10T12:07", "time:2024-03-10T12:20.. tgm" })
+    {
+        set_filter (text);
+        CHECK (shown () == naive (text));
+        CHECK (!shown ().empty ());
+    }
+    set_filter ("");
+}
+
+/// With the log index, the first filter level still gets what a scan would, as records come and go
+
+static void
+test_indexed ()
+{
+    reset_log ();
+    console.index_log = true;
+    index_log_trigrams ();
+    console.log_max_records = 50;
+
+    const char* texts[] = { "additem", "Riverwood", "not found", "tgm", "0000000f", "dir:out coc",
+        "em pl", "xyz" };
+    for (int i = 0; i < 500; ++i)
+    {
+        std::string msg;
+        for (int k = int (rng () % 3) + 1; k--; )
+            msg += std::string (words[rng () % std::size (words)]) + ' ';
+        record_log_message (rng () % 2, msg);
+        if (i % 5 == 0)
+        {
+            std::string text = texts[rng () % std::size (texts)];
+            set_filter (text);
+            CHECK (shown () == naive (text));
+        }
+    }
+
+    console.log_max_records = 0;
+    console.index_log = false;
+    index_log_trigrams ();
+    set_filter ("");
+}
+
+/// Stepping through the matches, with records appended and evicted in between, against the
+/// matches of the kept records, told apart by how many records were recorded before them
+
+static void
+test_finder ()
+{
+    reset_log ();
+    std::size_t recorded = 0, evicted = 0;
+    auto record = [&recorded] (std::size_t count)
+    {
+        for (; count--; ++recorded)
+        {
+            std::string msg = recorded % 5000 ? "" : "needle ";
+            for (int k = int (rng () % 3) + 1; k--; )
+                msg += std::string (words[rng () % std::size (words)]) + ' ';
+            record_log_message (rng () % 2, msg);
+        }
+    };
+    record (3 * records_finder<log_index, log_text>::chunk_records);
+
+    const char* texts[] = { "needle", "additem", "in: tgm", "coc OR health", "-tgm", "xyz",
+        "re:rive?r" };
+    std::string text;
+    std::vector<std::size_t> matches;
+    auto rematch = [&text, &matches, &evicted]
+    {
+        text_query query (text);
+        matches.clear ();
+        for (std::size_t k = 0; k < console.log_indexes.size (); ++k)
+        {
+            auto const& i = console.log_indexes[k];
+            auto [b, e] = extract_message (console.log_data, i);
+            if (query.contains (b, e, record_direction (i)))
+                matches.push_back (evicted + k);
+        }
+    };
+
+    const auto none = std::size_t (-1);
+    auto current = none;
+    auto failures = failures_so_far ();
+    for (int n = 0; n < 2000 && failures_so_far () == failures; ++n)
+    {
+        auto action = rng () % 20;
+        if (action < 2 || text.empty ())
+        {
+            std::string t = texts[rng () % std::size (texts)];
+            CHECK (console.log_finder.find (t));
+            if (t != text)
+                current = none;
+            text = t;
+            rematch ();
+        }
+        else if (action < 4)
+        {
+            // Found after these scanned already
+            record (rng () % 40);
+            rematch ();
+        }
+        else if (action < 6)
+        {
+            // Not found anymore, also the one gone to
+            auto count = std::min<std::size_t> (rng () % 2 ? rng () % 30 : rng () % 10000,
+                    console.log_indexes.size () - 1);
+            auto before = console.log_indexes.size ();
+            console.log_max_records = before - count;
+            evict_log_records (false);
+            console.log_max_records = 0;
+            evicted += before - console.log_indexes.size ();
+            matches.erase (matches.begin (),
+                    std::lower_bound (matches.begin (), matches.end (), evicted));
+            if (current != none && current < evicted)
+                CHECK (console.log_finder.found () == console.log_finder.npos);
+        }
+        else
+        {
+            // The next or the previous match, wrapping around at the ends
+            bool forward = action < 13;
+            if (!matches.empty ())
+            {
+                auto m = std::lower_bound (matches.begin (), matches.end (), current);
+                if (current == none)
+                    current = forward ? matches.front () : matches.back ();
+                else if (forward)
+                {
+                    m = std::upper_bound (matches.begin (), matches.end (), current);
+                    current = m == matches.end () ? matches.front () : *m;
+                }
+                else
+                    current = m == matches.begin () ? matches.back () : *std::prev (m);
+            }
+            CHECK ((forward ? console.log_finder.next () : console.log_finder.previous ())
+                    == !matches.empty ());
+            if (!matches.empty ())
+                CHECK (evicted + console.log_finder.found () == current);
+        }
+    }
+    console.log_finder.find ("");
+    reset_log ();
+}
+
+/// Whether the folded copies are of the current texts, as needed wrt to console#fold_copies
+
+static bool
+folded_in_sync ()
+{
+    if (!console.fold_copies)
+        return console.log_folded.capacity () == 0 && console.alias_folded.empty ();
+    for (auto const& i: console.log_indexes)
+    {
+        auto [b, e] = extract_message (console.log_data, i);
+        auto [fb, fe] = extract_message (console.log_folded, i);
+        if (!std::equal (b, e, fb, fe, [] (char a, char f) { return fold_ascii (a) == f; }))
+            return false;
+    }
+    auto const& a = console.alias_data;
+    auto const& f = console.alias_folded;
+    return std::equal (a.begin (), a.end (), f.begin (), f.end (),
+            [] (char a, char f) { return fold_ascii (a) == f; });
+}
+
+/// The commands which replace or edit the texts keep the folded copies along
+
+static void
+test_folded_sync ()
+{
+    reset_log ();
+    for (int i = 0; i < 50; ++i)
+        record_log_message (i % 2, std::string (words[i % std::size (words)]) + " OF "
+                + words[i % 3]);
+    CHECK (folded_in_sync ());
+    set_filter ("coc");
+    CHECK (shown () == naive ("coc"));
+
+    console.log_max_records = 20;
+    record_log_message (true, "Player.AddItem F 1");
+    console.log_max_records = 0;
+    CHECK (folded_in_sync ());
+    set_filter ("additem");
+    CHECK (shown () == naive ("additem"));
+
+    execute_command ("/save folded");
+    execute_command ("/clear");
+    CHECK (console.log_indexes.size () <= 1 && folded_in_sync ());
+    execute_command ("/load folded");
+    CHECK (console.log_indexes.size () > 10 && folded_in_sync ());
+    set_filter ("additem");
+    CHECK (!shown ().empty () && shown () == naive ("additem"));
+    std::filesystem::remove (plugin_directory () + "folded.log");
+
+    execute_command ("/alias TestFold Player.AddItem <item> <count>");
+    CHECK (folded_in_sync ());
+    execute_command ("/alias OtherFold COC Riverwood");
+    execute_command ("/alias-delete TestFold");
+    CHECK (!console.alias_indexes.empty () && folded_in_sync ());
+    execute_command ("/alias-delete OtherFold");
+    CHECK (console.alias_indexes.empty () && folded_in_sync ());
+    set_filter ("");
+}
+
+/// Records evicted while the result is made in the background, so it is made again
+
+static void
+test_background_interrupted ()
+{
+    reset_log ();
+    console.log_filter.background (100);
+    for (int i = 0; i < 20000; ++i)
+        record_log_message (i % 2, i % 7 ? "tgm" : "player.additem 0000000f 1");
+
+    for (auto text: { "additem", "0000000f" })
+    {
+        set_filter (text);
+        CHECK (console.log_filter.pending ());
+        console.log_max_records = console.log_indexes.size () - 1000;
+        evict_log_records (false);
+        for (int i = 0; i < 10000 && (console.log_filter.pending () || i == 0); ++i)
+        {
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+            console.log_filter.poll ();
+        }
+        CHECK (!console.log_filter.pending ());
+        CHECK (shown () == naive (text));
+        set_filter ("");
+    }
+    reset_log ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// All of them, without and with the folded copies of the texts
+
+void
+test_filter ()
+{
+    for (bool fold: { false, true })
+    {
+        console.fold_copies = fold;
+        fold_log_copy ();
+        fold_help_copies ();
+        test_single_scoped ();
+        test_random_queries ();
+        test_direction_alias ();
+        test_time_unordered ();
+        test_indexed ();
+        test_finder ();
+        test_folded_sync ();
+        test_background_interrupted ();
+    }
+    console.fold_copies = false;
+    fold_log_copy ();
+    fold_help_copies ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
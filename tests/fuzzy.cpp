@@ -0,0 +1,174 @@
+/**
+ * @file fuzzy.cpp
+ * @brief Checks of the fuzzy matching and of its ranking
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include "fuzzy.hpp"
+#include <random>
+#include <set>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (19);
+
+static int
+score (std::string_view pattern, std::string_view text)
+{
+    fuzzy_pattern::match m;
+    return fuzzy_pattern (pattern).score (text, m) ? m.score : -1000;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+test_score ()
+{
+    fuzzy_pattern::match m;
+    CHECK (fuzzy_pattern ("addtem").score ("player.AddItem", m));
+    CHECK (m.offset == 7 && m.length == 7);
+    CHECK (!fuzzy_pattern ("abc").score ("acb", m));
+    CHECK (!fuzzy_pattern ("abc").score ("ab", m));
+    CHECK (!fuzzy_pattern ("").score ("ab", m));
+
+    // The shortest part is scored, the last one ending first
+    CHECK (fuzzy_pattern ("ab").score ("a a ab", m) && m.offset == 4 && m.length == 2);
+
+    // In a row, then at the word starts and the camel humps, then apart
+    CHECK (score ("abc", "xabc") > score ("abc", "xaxbc"));
+    CHECK (score ("abc", "xaxbc") > score ("abc", "xaxbxc"));
+    CHECK (score ("gi", "GetItem") > score ("gi", "vagina"));
+    CHECK (score ("gi", "get_item") > score ("gi", "vagina"));
+    CHECK (score ("tm", "the.moon") > score ("tm", "teammate"));
+    CHECK (score ("additem", "player.additem") == score ("additem", "AddItem"));
+    CHECK (score ("ADDITEM", "additem") == score ("additem", "AddItem"));
+}
+
+/// The top ones are the first of all the candidates sorted by the score, then by the length and
+/// then as pushed
+
+static void
+test_top ()
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        std::vector<fuzzy_top::entry> all;
+        for (std::uint32_t k = 0, n = rng () % 100; k < n; ++k)
+            all.push_back (fuzzy_top::entry { int (rng () % 8), std::uint32_t (rng () % 4), k, k });
+        std::stable_sort (all.begin (), all.end (), [] (auto const& a, auto const& b) {
+            return a.score != b.score ? a.score > b.score : a.length < b.length;
+        });
+
+        std::size_t capacity = rng () % 20;
+        fuzzy_top top (capacity);
+        for (int repeat = 0; repeat < 2; ++repeat)
+        {
+            for (std::uint32_t k = 0; k < all.size (); ++k)
+            {
+                auto const& e = *std::find_if (all.begin (), all.end (),
+                        [k] (auto const& a) { return a.key == k; });
+                top.push (e.score, e.length, e.key);
+            }
+            auto taken = top.take ();
+            CHECK (taken.size () == std::min (capacity, all.size ()));
+            for (std::size_t n = 0; n < taken.size (); ++n)
+                CHECK (taken[n].key == all[n].key);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Appends a help record, having these names
+static void
+add_help (std::string const& names)
+{
+    help_index i {};
+    i.begin = std::uint32_t (console.sse_data.size ());
+    i.params = std::uint32_t (names.size ());
+    i.brief = 1;
+    console.sse_data.insert (console.sse_data.end (), names.begin (), names.end ());
+    console.sse_data.push_back ('.');
+    console.sse_indexes.push_back (i);
+}
+
+/// Records with many close names compete each once, so they don't push out the others
+
+static void
+test_help_search ()
+{
+    auto sse_data = console.sse_data;
+    auto sse_indexes = console.sse_indexes;
+    console.sse_data.clear ();
+    console.sse_indexes.clear ();
+
+    for (int r = 0; r < 3; ++r)
+    {
+        std::string names;
+        for (int n = 0; n < 12; ++n)
+            names += "x_z" + std::to_string (r * 12 + n) + ' ';
+        names.pop_back ();
+        add_help (names);
+    }
+    for (int r = 0; r < 20; ++r)
+        add_help ("xaaz" + std::to_string (r));
+    fold_help_copies ();
+
+    auto& h = console.all_help;
+    h.init ();
+    h.update ("xz");
+    auto const& results = *h.current_indexes ();
+    std::set<std::uint32_t> distinct;
+    for (auto const& i: results)
+        distinct.insert (i.begin);
+    CHECK (results.size () == 23);
+    CHECK (distinct.size () == results.size ());
+
+    // The closest names first, with where they match
+    for (std::size_t n = 0; n < results.size (); ++n)
+    {
+        std::string_view name (&console.sse_data[results[n].begin + h.highlight (n).offset], 3);
+        CHECK (name.substr (0, 1) == "x");
+        CHECK ((n < 3) == (name == "x_z"));
+    }
+
+    console.sse_data = sse_data;
+    console.sse_indexes = sse_indexes;
+    fold_help_copies ();
+    h.init ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_fuzzy ()
+{
+    test_score ();
+    test_top ();
+    test_help_search ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,160 @@
+/**
+ * @file help.cpp
+ * @brief Checks of the search over all of the help
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+
+//--------------------------------------------------------------------------------------------------
+
+/// As load_help_file() lays out a record: the names after a space, then the other parts
+
+static void
+add_help (std::vector<char>& data, std::vector<help_index>& indexes, std::string const& names,
+        std::string const& brief, std::string const& details)
+{
+    help_index i {};
+    i.begin = std::uint32_t (data.size ());
+    i.params = std::uint32_t (names.size ());
+    i.brief = 0;
+    i.details = std::uint32_t (brief.size ());
+    i.end = std::uint32_t (details.size ());
+    data.insert (data.end (), names.begin (), names.end ());
+    data.insert (data.end (), brief.begin (), brief.end ());
+    data.insert (data.end (), details.begin (), details.end ());
+    indexes.push_back (i);
+}
+
+/// The first name of each record found, in the order shown
+
+static std::vector<std::string>
+search (const char* text)
+{
+    auto& all = console.all_help;
+    *std::copy_n (text, std::strlen (text), all.buffer.begin ()) = '\0';
+    all.update (all.buffer.data ());
+
+    std::vector<std::string> r;
+    for (auto const& i: *all.current_indexes ())
+    {
+        auto [n, p, b, d, e] = extract_message (all.source_data (i), i);
+        r.emplace_back (n, std::find (n, p, ' '));
+    }
+    return r;
+}
+
+static void
+clear_help ()
+{
+    for (auto& d: { &console.sse_data, &console.gui_data, &console.alias_data })
+        d->clear ();
+    for (auto& i: { &console.sse_indexes, &console.gui_indexes, &console.alias_indexes })
+        i->clear ();
+    fold_help_copies ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// The exact names first, then the names starting with it (the shorter first), then the names
+/// holding it, then the brief and last the details
+
+static void
+test_ranking ()
+{
+    clear_help ();
+    auto& sse = console.sse_data;
+    auto& sse_indexes = console.sse_indexes;
+    add_help (sse, sse_indexes, "AddItemMenu aim", "Opens an item menu.", "");
+    add_help (sse, sse_indexes, "FindForm", "Form lookup.", "");
+    add_help (sse, sse_indexes, "GetFind gf", "", "");
+    add_help (sse, sse_indexes, "Help", "Lists the commands which FIND something.", "");
+    add_help (sse, sse_indexes, "Zap", "Removes.", "Can find all of them.");
+    add_help (sse, sse_indexes, "FindIt f", "", "");
+    add_help (sse, sse_indexes, "Fin Find", "", "");
+    add_help (console.gui_data, console.gui_indexes, "/finder", "Finds.", "");
+    add_help (console.alias_data, console.alias_indexes, ".find", "coc riverwood", "");
+    fold_help_copies ();
+
+    using names = std::vector<std::string>;
+    CHECK (search ("find") == (names { "Fin", "FindIt", "FindForm", "GetFind", "/finder",
+                ".find", "Help", "Zap" }));
+    CHECK (search ("FORM") == (names { "FindForm" }));
+    CHECK (search ("menu") == (names { "AddItemMenu" }));
+    CHECK (search ("all") == (names { "Zap" }));
+    CHECK (search ("aim") == (names { "AddItemMenu" }));
+    CHECK (search ("").size () == 9);
+
+    clear_help ();
+}
+
+/// Aliases are put in and taken out of the index on their own, as if it was made anew
+
+static void
+test_aliases ()
+{
+    clear_help ();
+    add_help (console.gui_data, console.gui_indexes, "/filter", "Filters the Log.", "");
+    fold_help_copies ();
+
+    auto same_as_remade = [] (const char* text)
+    {
+        auto found = search (text);
+        console.all_help.reset ();
+        return found == search (text);
+    };
+
+    using names = std::vector<std::string>;
+    execute_command ("/alias FindMe coc riverwood");
+    execute_command ("/alias Fi player.additem f 1");
+    execute_command ("/alias Find help filter");
+    CHECK (search (".fi") == (names { ".Fi", ".Find", ".FindMe" }));
+    CHECK (same_as_remade (".fi") && same_as_remade ("filter") && same_as_remade (""));
+
+    execute_command ("/alias-delete Fi");
+    CHECK (search (".fi") == (names { ".Find", ".FindMe" }));
+    CHECK (search ("filter") == (names { "/filter", ".Find" }));
+    CHECK (same_as_remade (".fi") && same_as_remade ("riverwood") && same_as_remade ("f"));
+
+    execute_command ("/alias-delete FindMe");
+    execute_command ("/alias-delete Find");
+    CHECK (search (".fi").empty () && search ("") == (names { "/filter" }));
+    CHECK (console.alias_indexes.empty ());
+
+    clear_help ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_help ()
+{
+    test_ranking ();
+    test_aliases ();
+    *console.all_help.buffer.begin () = '\0';
+    console.all_help.update ("");
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,169 @@
+/**
+ * @file log.cpp
+ * @brief Checks of the log storage and its eviction
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+
+//--------------------------------------------------------------------------------------------------
+
+static std::string_view
+message (std::size_t i)
+{
+    auto [b, e] = extract_message (console.log_data, console.log_indexes[i]);
+    return std::string_view (b, std::size_t (e - b));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/// Whatever the limits, the newest record stays
+
+static void
+test_eviction ()
+{
+    reset_log ();
+    CHECK (clamp_log_bytes (0) == 0);
+    CHECK (clamp_log_bytes (1 << 20) == min_log_bytes);
+    CHECK (clamp_log_bytes (std::size_t (1) << 40) == max_log_bytes);
+
+    console.log_max_bytes = clamp_log_bytes (1 << 20);
+    for (int i = 0; i < 100; ++i)
+        record_log_message (true, "tgm " + std::to_string (i));
+    CHECK (console.log_indexes.size () == 100);
+
+    // Even if set around the clamping, less than a chunk
+    console.log_max_bytes = 1 << 20;
+    std::string large (3 << 20, 'x');
+    for (int i = 0; i < 8; ++i)
+    {
+        record_log_message (false, std::to_string (i) + large);
+        CHECK (!console.log_indexes.empty ());
+        CHECK (message (console.log_indexes.size () - 1).starts_with (std::to_string (i) + "x"));
+    }
+
+    console.log_max_records = 10;
+    for (int i = 0; i < 100; ++i)
+        record_log_message (true, "tgm " + std::to_string (i));
+    CHECK (!console.log_indexes.empty () && console.log_indexes.size () <= 10);
+    CHECK (message (console.log_indexes.size () - 1) == "tgm 99");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * More than 4 GiB of text through a bytes limit, with records which half fill a chunk, so that
+ * the offsets would wrap around if not renumbered, with a filter and the folded copy following.
+ */
+
+static void
+test_offsets ()
+{
+    reset_log ();
+    console.fold_copies = true;
+    fold_log_copy ();
+    console.log_max_bytes = min_log_bytes;
+
+    std::string filler (log_text::chunk_size / 2 + 1, 'x');
+    std::size_t written = 0;
+    auto failures = failures_so_far ();
+    for (int i = 0; written <= (std::size_t (1) << 32) + log_text::chunk_size; ++i)
+    {
+        auto msg = (i % 3 ? "plain " : "marker ") + std::to_string (i) + ' ' + filler;
+        record_log_message (true, msg);
+        written += log_text::chunk_size;
+        console.log_filter.update ("marker");      // As on each frame
+
+        auto const& indexes = console.log_indexes;
+        auto n = indexes.size ();
+        CHECK (n && message (n-1) == msg);
+        CHECK (n && console.log_data.data (indexes[n-1].begin)
+                + (indexes[n-1].size - 1) == &message (n-1).back ());
+        for (std::size_t k = 1; k < n; ++k)
+            CHECK (indexes[k-1].begin < indexes[k].begin);
+
+        // The filter follows, showing these of the kept records with the marker
+        std::size_t markers = 0;
+        for (std::size_t k = 0; k < n; ++k)
+            markers += message (k).starts_with ("marker");
+        auto const& shown = *console.log_filter.current_indexes ();
+        CHECK (shown.size () == markers);
+        for (auto const& s: shown)
+        {
+            CHECK (std::any_of (indexes.begin (), indexes.end (),
+                        [&s] (log_index const& i) { return i.begin == s.begin; }));
+            auto [b, e] = extract_message (console.log_folded, s);
+            CHECK (std::string_view (b, std::size_t (e - b)).starts_with ("marker"));
+        }
+        if (failures_so_far () != failures)
+            break;
+    }
+
+    console.fold_copies = false;
+    fold_log_copy ();
+    reset_log ();
+}
+
+/// The times, counters and directions come back from the saved prompts, also around midnight
+
+static void
+test_save_load ()
+{
+    reset_log ();
+    for (int i = 0; i < 5; ++i)
+        record_log_message (i % 2, "tgm " + std::to_string (i));
+    console.log_indexes[1].time = 1704067199;   // 2023-12-31 23:59:59 UTC, near some midnight
+    console.log_indexes[2].time = 1704067200;
+    auto expected = console.log_indexes;
+    std::vector<std::string> messages;
+    for (std::size_t i = 0; i < expected.size (); ++i)
+        messages.emplace_back (message (i));
+
+    CHECK (save_log_file ("saved.log"));
+    reset_log ();
+    CHECK (load_log_file ("saved.log"));
+    CHECK (console.log_indexes.size () == expected.size ());
+    for (std::size_t i = 0; i < expected.size () && i < console.log_indexes.size (); ++i)
+    {
+        auto const& a = console.log_indexes[i];
+        CHECK (message (i) == messages[i]);
+        CHECK (a.time == expected[i].time);
+        CHECK (a.counter == expected[i].counter && a.out == expected[i].out);
+    }
+    std::filesystem::remove ("saved.log");
+    reset_log ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_log ()
+{
+    test_eviction ();
+    test_save_load ();
+    test_offsets ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,170 @@
+/**
+ * @file ordinals.cpp
+ * @brief Checks of the ordinal sets against the standard ones
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include "ordinals.hpp"
+#include <random>
+#include <set>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (17);
+
+/// Over a few containers, each part sparse or dense enough to be an array or a bitmap, also
+/// right around the limit between them
+
+static std::set<std::uint32_t>
+random_ordinals ()
+{
+    static const std::uint32_t per_container[] = {
+        0, 1, 100, ordinal_set::array_limit - 1, ordinal_set::array_limit,
+        ordinal_set::array_limit + 1, 30000, 65536
+    };
+    std::set<std::uint32_t> r;
+    for (std::uint32_t key = 0; key < 4; ++key)
+    {
+        // Each of the rest taken as likely as there are still to take than left to go
+        auto n = per_container[rng () % std::size (per_container)];
+        for (std::uint32_t low = 0; low < 65536 && n; ++low)
+            if (rng () % (65536 - low) < n)
+            {
+                r.insert (r.end (), key << 16 | low);
+                --n;
+            }
+    }
+    return r;
+}
+
+static ordinal_set
+make (std::set<std::uint32_t> const& ordinals)
+{
+    ordinal_set s;
+    for (auto o: ordinals)
+        s.push_back (o);
+    return s;
+}
+
+/// Whether the rest of the set, from the iterator, is the rest of the expected one, as far as
+/// the steps go
+
+static bool
+same (ordinal_set::const_iterator it, ordinal_set const& s,
+        std::set<std::uint32_t>::const_iterator e, std::set<std::uint32_t> const& expected,
+        std::size_t steps = SIZE_MAX)
+{
+    for (; !(it == s.end ()) && e != expected.end (); ++it, ++e)
+    {
+        if (!steps--)
+            return true;
+        if (*it != *e)
+            return false;
+    }
+    return it == s.end () && e == expected.end ();
+}
+
+static bool
+same (ordinal_set const& s, std::set<std::uint32_t> const& expected)
+{
+    return s.size () == expected.size () && s.empty () == expected.empty ()
+        && same (s.begin (), s, expected.begin (), expected);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+test_lower_bound (ordinal_set const& s, std::set<std::uint32_t> const& expected)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        std::uint32_t o = rng () % (5 << 16);
+        if (i % 2 && !expected.empty ())    // Also right at and next to the ordinals
+            o = *std::next (expected.begin (), rng () % expected.size ()) + rng () % 3 - 1;
+        auto it = s.lower_bound (o);
+        auto e = expected.lower_bound (o);
+        CHECK ((it == s.end ()) == (e == expected.end ()));
+        if (it != s.end () && e != expected.end ())
+        {
+            CHECK (*it == *e);
+            CHECK (same (it, s, e, expected, 100));
+        }
+    }
+}
+
+static void
+test_erase_below (std::set<std::uint32_t> const& ordinals)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        auto s = make (ordinals);
+        auto expected = ordinals;
+        std::uint32_t o = rng () % (5 << 16);
+        if (i % 2 && !expected.empty ())
+            o = *std::next (expected.begin (), rng () % expected.size ()) + rng () % 2;
+        expected.erase (expected.begin (), expected.lower_bound (o));
+        s.erase_below (o);
+        CHECK (same (s, expected));
+
+        // Still usable after, also to append to
+        std::uint32_t next = expected.empty () ? o : *expected.rbegin () + 1;
+        s.push_back (next);
+        expected.insert (next);
+        CHECK (same (s, expected));
+    }
+}
+
+static void
+test_intersection (std::set<std::uint32_t> const& a, std::set<std::uint32_t> const& b)
+{
+    std::set<std::uint32_t> expected;
+    std::set_intersection (a.begin (), a.end (), b.begin (), b.end (),
+            std::inserter (expected, expected.end ()));
+    auto s = make (a);
+    s &= make (b);
+    CHECK (same (s, expected));
+    test_lower_bound (s, expected);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_ordinals ()
+{
+    for (int i = 0; i < 30; ++i)
+    {
+        auto a = random_ordinals (), b = random_ordinals ();
+        auto s = make (a);
+        CHECK (same (s, a));
+        test_lower_bound (s, a);
+        test_erase_below (a);
+        test_intersection (a, b);
+        test_intersection (a, a);
+        test_intersection (a, {});
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
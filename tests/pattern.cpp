@@ -0,0 +1,175 @@
+/**
+ * @file pattern.cpp
+ * @brief Checks of the patterns against the standard regular expressions
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include "pattern.hpp"
+#include <regex>
+#include <random>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (11);
+
+static bool
+matches (std::string_view pattern, std::string_view text,
+        text_pattern::syntax_type syntax = text_pattern::regex)
+{
+    text_pattern p;
+    if (!p.compile (pattern, syntax).empty ())
+        return false;
+    return p.matches (text.data (), text.data () + text.size ());
+}
+
+static bool
+compiles (std::string_view pattern, text_pattern::syntax_type syntax = text_pattern::regex)
+{
+    text_pattern p;
+    return p.compile (pattern, syntax).empty ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+test_examples ()
+{
+    CHECK (matches ("^set", "SetAV health 100"));
+    CHECK (!matches ("^set", "getav setav"));
+    CHECK (matches ("av$", "player.getav"));
+    CHECK (matches ("a{2,3}x", "baaax"));
+    CHECK (!matches ("^a{2,3}x", "ax"));
+    CHECK (matches ("\\d+\\.\\d+", "health >> 12.50"));
+    CHECK (matches ("[^a-z ]", "abc 1"));
+    CHECK (!matches ("[^a-z ]", "abc def"));
+
+    // The word boundaries, also next to the start and the end
+    CHECK (matches ("\\bfoo", "a foo"));
+    CHECK (matches ("\\bfoo", "foo"));
+    CHECK (!matches ("\\bfoo", "afoo"));
+    CHECK (matches ("foo\\b", "foo.bar"));
+    CHECK (!matches ("foo\\b", "foobar"));
+    CHECK (matches ("\\Boo", "foo"));
+    CHECK (!matches ("\\Bfoo", "foo"));
+    CHECK (matches ("\\b", "x"));
+    CHECK (!matches ("\\b", " "));
+
+    // The control escapes are the bytes, also within classes
+    CHECK (matches ("a\\nb", "a\nb"));
+    CHECK (!matches ("a\\nb", "anb"));
+    CHECK (matches ("a\\tb", "a\tb"));
+    CHECK (matches ("[\\t\\n]x", "\nx"));
+    CHECK (matches ("[\\b]", "\b"));
+    CHECK (!compiles ("\\x41"));
+    CHECK (!compiles ("[\\q]"));
+    CHECK (compiles ("\\.\\*\\[\\\\"));
+
+    // The globs take the escaped letters as they are
+    CHECK (matches ("*\\n*", "n", text_pattern::glob));
+    CHECK (matches ("a?c", "xabcx", text_pattern::glob));
+    CHECK (matches ("[!a]b", "cb", text_pattern::glob));
+    CHECK (!matches ("[!a]b", "ab", text_pattern::glob));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static std::string
+random_pattern (int depth, bool& dot)
+{
+    static const char* atoms[] = {
+        "a", "b", "A", "_", " ", "1", ".", "[a-c]", "[^b]", "[\\d_]", "\\d", "\\w", "\\W", "\\s",
+        "\\S", "\\b", "\\B", "\\n", "\\t", "^", "$"
+    };
+    static const char* quantifiers[] = { "", "", "", "*", "+", "?", "{1,2}", "{2}" };
+    std::string p;
+    for (int n = int (rng () % 4) + 1; n--; )
+    {
+        std::string a;
+        if (depth < 2 && rng () % 6 == 0)
+            a = "(" + random_pattern (depth + 1, dot) + "|" + random_pattern (depth + 1, dot) + ")";
+        else
+            a = atoms[rng () % std::size (atoms)];
+        dot |= a == ".";
+        bool assertion = a == "^" || a == "$" || a == "\\b" || a == "\\B";
+        p += a + (assertion ? "" : quantifiers[rng () % std::size (quantifiers)]);
+    }
+    return p;
+}
+
+static std::string
+random_text (bool dot)
+{
+    static const char letters[] = "aAbBc_1 -\n\t";
+    std::string t;
+    for (int n = int (rng () % 8); n--; )
+        t += letters[rng () % (std::size (letters) - 1 - (dot ? 2 : 0))];
+    return t;
+}
+
+/// The standard ones don't let "." match the line breaks, hence no such text for them
+
+static void
+test_random ()
+{
+    for (int i = 0; i < 3000; ++i)
+    {
+        bool dot = false;
+        auto p = random_pattern (0, dot);
+        std::regex re;
+        try {
+            re.assign (p, std::regex::ECMAScript | std::regex::icase);
+        }
+        catch (std::regex_error const&) {
+            continue;
+        }
+        text_pattern tp;
+        auto error = tp.compile (p, text_pattern::regex);
+        if (error == "too complex")
+            continue;
+        CHECK (error.empty ());
+        if (!error.empty ())
+            continue;
+        for (int k = 0; k < 20; ++k)
+        {
+            auto t = random_text (dot);
+            bool expected = std::regex_search (t, re);
+            CHECK (tp.matches (t.data (), t.data () + t.size ()) == expected);
+            if (tp.matches (t.data (), t.data () + t.size ()) != expected)
+                std::cerr << "  re:" << p << " on \"" << t << "\"" << std::endl;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_pattern ()
+{
+    test_examples ();
+    test_random ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,159 @@
+/**
+ * @file query.cpp
+ * @brief Checks of the queries, also of which one implies another
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include "query.hpp"
+#include <random>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (13);
+
+static bool
+holds (std::string_view query, std::string_view text, int direction = 0)
+{
+    text_query q (query);
+    return q.contains (text.data (), text.data () + text.size (), direction);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void
+test_examples ()
+{
+    CHECK (holds ("additem", "player.AddItem f 1"));
+    CHECK (!holds ("additem", "player.additm f 1"));
+    CHECK (holds ("additem player OR npc", "player.additem"));
+    CHECK (!holds ("additem player OR npc", "player.removeitem"));
+    CHECK (holds ("coc -tgm", "coc riverwood"));
+    CHECK (!holds ("coc -tgm", "coc riverwood; tgm"));
+    CHECK (!holds ("coc NOT tgm", "tgm coc"));
+    CHECK (holds ("\"not found\"", "item NOT FOUND"));
+    CHECK (!holds ("\"not found\"", "not  found"));
+    CHECK (holds ("re:^get.*\\d$", "getav health 5"));
+    CHECK (!holds ("re:^get.*\\d$", "setav health 5"));
+    CHECK (holds ("glob:*.esp", "skyrim.esp"));
+    CHECK (holds ("out:tgm", "tgm", 1));
+    CHECK (!holds ("out:tgm", "tgm", -1));
+    CHECK (holds ("in:", "anything", -1));
+    CHECK (!holds ("in:", "anything", 1));
+
+    // The unfinished terms are left out, the invalid patterns are errors
+    CHECK (holds ("coc -", "coc"));
+    CHECK (holds ("coc \"", "coc"));
+    CHECK (!text_query ("re:(a").error ().empty ());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static const char* tokens[] = {
+    "a", "ab", "abc", "b", "bc", "-a", "-ab", "NOT b", "OR", "|", "\"a b\"", "re:a.c",
+    "re:^b", "glob:a*c", "in:", "out:", "in:a", "out:-b", "-in:"
+};
+
+static std::string
+random_query ()
+{
+    std::string q;
+    for (int n = int (rng () % 4); n--; )
+        q += std::string (tokens[rng () % std::size (tokens)]) + ' ';
+    return q;
+}
+
+/// Of the random queries, the typed prefixes too, as the filters meet them the most
+
+static void
+test_implies ()
+{
+    std::vector<std::pair<std::string, int>> records;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string t;
+        for (int n = int (rng () % 7); n--; )
+            t += "aAbc "[rng () % 5];
+        records.emplace_back (t, int (rng () % 3) - 1);
+    }
+
+    std::vector<std::string> queries;
+    for (int i = 0; i < 150; ++i)
+    {
+        auto q = random_query ();
+        for (std::size_t n = 0; n <= q.size (); n += 1 + rng () % 3)
+            queries.push_back (q.substr (0, n));
+    }
+
+    std::vector<text_query> compiled;
+    std::vector<std::vector<bool>> results;
+    for (auto const& q: queries)
+    {
+        compiled.emplace_back (q);
+        auto& r = results.emplace_back ();
+        for (auto const& [t, d]: records)
+        {
+            auto first = t.data (), last = first + t.size ();
+            bool h = compiled.back ().contains (first, last, d);
+            r.push_back (h);
+            std::string folded (t);
+            for (auto& c: folded)
+                c = fold_ascii (c);
+            CHECK (compiled.back ().contains_folded (
+                        folded.data (), folded.data () + folded.size (), d) == h);
+        }
+    }
+
+    for (std::size_t i = 0; i < compiled.size (); ++i)
+        for (std::size_t j = 0; j < compiled.size (); ++j)
+        {
+            if (!compiled[i].error ().empty () || !compiled[j].error ().empty ()
+                    || !compiled[i].implies (compiled[j]))
+                continue;
+            for (std::size_t k = 0; k < records.size (); ++k)
+                if (results[i][k] && !results[j][k])
+                {
+                    CHECK (!"the implied query holds");
+                    std::cerr << "  \"" << queries[i] << "\" implies \"" << queries[j]
+                              << "\" but not on \"" << records[k].first << "\"" << std::endl;
+                    break;
+                }
+        }
+
+    CHECK (text_query ("playe").implies (text_query ("pla")));
+    CHECK (!text_query ("pla").implies (text_query ("playe")));
+    CHECK (text_query ("-pla").implies (text_query ("-playe")));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_query ()
+{
+    test_examples ();
+    test_implies ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
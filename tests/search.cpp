@@ -0,0 +1,121 @@
+/**
+ * @file search.cpp
+ * @brief Checks of the case-insensitive search against the standard one
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ */
+
+#include "tests.hpp"
+#include "search.hpp"
+#include <random>
+#include <memory>
+
+//--------------------------------------------------------------------------------------------------
+
+static std::mt19937 rng (23);
+
+/// Few characters, so that the candidates are many, with these right around the letters
+static const char alphabet[] = "aAbBzZ@[`{\xc3";
+
+static std::string
+folded (std::string s)
+{
+    for (auto& c: s)
+        c = fold_ascii (c);
+    return s;
+}
+
+/**
+ * The lengths span the scalar search, the narrower and the wider blocks, including the last
+ * block which overlaps the previous one. The text is allocated to its exact size, so that any
+ * read past it would be caught by the address sanitizer.
+ */
+
+static void
+test_random ()
+{
+    auto failures = failures_so_far ();
+    for (int round = 0; round < 20000; ++round)
+    {
+        std::size_t size = rng () % 101;
+        std::string text;
+        for (std::size_t i = 0; i < size; ++i)
+            text += alphabet[rng () % (std::size (alphabet) - 1)];
+
+        // Often a part of the text in another case, so that there are matches anywhere
+        std::size_t n = rng () % 40 + 1;
+        std::string needle;
+        if (size >= n && rng () % 2)
+        {
+            needle = text.substr (rng () % (size - n + 1), n);
+            for (auto& c: needle)
+                if (rng () % 2 && c >= 'a' && c <= 'z')
+                    c = char (c - ('a' - 'A'));
+        }
+        else
+            for (std::size_t i = 0; i < n; ++i)
+                needle += alphabet[rng () % 4];
+
+        auto buffer = std::make_unique<char[]> (size);
+        std::copy (text.begin (), text.end (), buffer.get ());
+        auto first = buffer.get (), last = first + size;
+
+        auto expected = folded (text).find (folded (needle));
+        auto found = text_search (needle).find (first, last);
+        CHECK (found == (expected == std::string::npos ? last : first + expected));
+        if (failures_so_far () != failures)
+        {
+            std::cerr << "  \"" << needle << "\" in \"" << text << "\"" << std::endl;
+            break;
+        }
+    }
+}
+
+static void
+test_examples ()
+{
+    auto find = [] (std::string_view needle, std::string_view text) {
+        return text_search (needle).find (text.data (), text.data () + text.size ())
+            - text.data ();
+    };
+    CHECK (find ("additem", "player.AddItem f 1") == 7);
+    CHECK (find ("ADDITEM", "player.additem f 1") == 7);
+    CHECK (find ("x", "") == 0);
+    CHECK (find ("", "abc") == 0);
+    CHECK (find ("@", "`") == 1);
+    CHECK (find ("[", "{") == 1);
+    CHECK (find ("\xc3\xa9", "\xc3\x89") == 2);       // Only the ASCII letters fold
+    CHECK (text_search ("abc").contains (nullptr, nullptr) == false);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+test_search ()
+{
+    test_examples ();
+    test_random ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
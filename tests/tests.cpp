@@ -0,0 +1,95 @@
+/**
+ * @file tests.cpp
+ * @brief Behaviour checks of the console core
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ * Runs against the headless core (see platform_posix.cpp) in a scratch plugin directory under the
+ * system temporary folder, as the benchmarks do. Usage: `test`, silent unless something fails.
+ */
+
+#include "tests.hpp"
+#include <iostream>
+
+//--------------------------------------------------------------------------------------------------
+
+static int failures = 0;
+
+void
+check_failed (const char* what, const char* file, int line)
+{
+    std::cerr << file << ":" << line << ": failed " << what << std::endl;
+    ++failures;
+}
+
+int
+failures_so_far ()
+{
+    return failures;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void
+reset_log ()
+{
+    console.log_data.clear ();
+    console.log_folded.clear ();
+    console.log_trigrams.clear ();
+    console.log_indexes.clear ();
+    console.counter_in = console.counter_out = 0;
+    console.log_max_records = console.log_max_bytes = 0;
+    setup_console ();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int
+main ()
+{
+    auto dir = std::filesystem::temp_directory_path () / "sse-console-tests";
+    std::filesystem::create_directories (dir);
+    std::filesystem::current_path (dir);
+    std::filesystem::create_directories (plugin_directory ());
+
+    setup_console ();
+    console.log_archive = false;
+
+    test_log ();
+    test_filter ();
+    test_search ();
+    test_pattern ();
+    test_query ();
+    test_ordinals ();
+    test_help ();
+    test_fuzzy ();
+    test_completion ();
+
+    std::filesystem::current_path (std::filesystem::temp_directory_path ());
+    std::filesystem::remove_all (dir);
+    if (failures)
+        std::cerr << failures << " checks failed" << std::endl;
+    return failures ? 1 : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
@@ -0,0 +1,63 @@
+/**
+ * @file tests.hpp
+ * @brief Behaviour checks of the console core
+ * @internal
+ *
+ * This file is part of Skyrim SE Console mod.
+ *
+ *   Console is free software: you can redistribute it and/or modify it
+ *   under the terms of the GNU Lesser General Public License as published
+ *   by the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Console is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public
+ *   License along with Console. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @endinternal
+ *
+ * @ingroup Tests
+ *
+ * @details
+ * Each part of the core has a function checking its results, run in order by tests.cpp, which
+ * reports the failed checks and exits with non-zero if there were any.
+ */
+
+#ifndef SSE_CONSOLE_TESTS_HPP
+#define SSE_CONSOLE_TESTS_HPP
+
+#include "console.hpp"
+#include <iostream>
+
+//--------------------------------------------------------------------------------------------------
+
+/// Prints where and what failed, and counts it
+void check_failed (const char* what, const char* file, int line);
+
+/// So far, e.g. to stop a long loop early
+int failures_so_far ();
+
+#define CHECK(condition) \
+    ((condition) ? void () : check_failed (#condition, __FILE__, __LINE__))
+
+/// Clears the log and its filter, as left by a previous test
+void reset_log ();
+
+void test_log ();
+void test_filter ();
+void test_search ();
+void test_pattern ();
+void test_query ();
+void test_ordinals ();
+void test_help ();
+void test_fuzzy ();
+void test_completion ();
+
+//--------------------------------------------------------------------------------------------------
+
+#endif //SSE_CONSOLE_TESTS_HPP
+